@@ -3,12 +3,44 @@
 /// @file
 /// @brief Файл с объявлением интерфейса исполнителя блока команд
 
+#include "wait_strategy.h"
+#include <chrono>
 #include <cstddef>
+#include <string>
+#include <vector>
 
 namespace async {
 
 using handle_t = std::size_t;
 
+/// @brief Параметры исполнителя блоков команд
+struct Options
+{
+    bool durable_ = false; ///< Записывать блоки в файлы с групповой фиксацией на диск
+    std::chrono::milliseconds commitInterval_{10}; ///< Интервал групповой фиксации
+    std::size_t commitBytes_ = 1024 * 1024; ///< Объем данных, при накоплении которого фиксация выполняется досрочно
+    std::size_t commitMaxPending_ = 64 * 1024 * 1024; ///< Объем ожидающих фиксации данных, при котором запись блокируется
+    std::vector<int> executorCpus_; ///< Процессоры потока исполнителя, пустой набор означает отсутствие привязки
+    std::vector<int> sinkCpus_; ///< Процессоры потоков приемников данных, пустой набор означает отсутствие привязки
+    bool fair_ = false; ///< Обслуживать соединения справедливо (deficit round robin по байтам) вместо общей очереди
+    std::size_t fairQuantum_ = 1024; ///< Квант обслуживания соединения с весом 1 в байтах
+    bool files_ = true; ///< Записывать блоки в файлы bulk*.log
+    std::string forward_; ///< Адрес сборщика для пересылки блоков (host:port или unix:/path), пустая строка — без пересылки
+    std::size_t forwardBatchBytes_ = 64 * 1024; ///< Размер пакета пересылки
+    std::size_t forwardInFlight_ = 4; ///< Максимальное количество неподтвержденных пакетов пересылки
+    std::size_t forwardBufferBytes_ = 64 * 1024 * 1024; ///< Лимит памяти под ожидающие пакеты пересылки
+    std::string forwardSpill_ = "bulk_forward.spill"; ///< Файл для пакетов пересылки сверх лимита памяти
+    WaitStrategy wait_; ///< Стратегия ожидания данных потоком исполнителя
+    bool intern_ = false; ///< Хранить повторяющиеся команды в единственном экземпляре
+    std::size_t internCapacity_ = 64 * 1024; ///< Максимальное количество команд в таблице интернирования
+    std::size_t internMaxLength_ = 256; ///< Максимальная длина интернируемой команды
+};
+
+/// @brief Задать параметры исполнителя блоков команд
+/// @param options параметры
+/// @note Вызывается до первого подключения к исполнителю
+void configure(const Options& options);
+
 /// @brief Подключиться к исполнителю блоков команд
 /// @param bulk размер блока команд
 /// @return контекст
@@ -20,8 +52,38 @@ handle_t connect(std::size_t bulk);
 /// @param size размер буфера
 void receive(handle_t handle, const char *data, std::size_t size);
 
+/// @brief Порция строковых данных контекста для пакетной передачи
+struct Chunk
+{
+    handle_t handle_;   ///< Контекст
+    const char *data_;  ///< Указатель на буфер данных
+    std::size_t size_;  ///< Размер буфера
+};
+
+/// @brief Передать строковые данные нескольких контекстов за один вызов
+/// @details Контексты ищутся под одной блокировкой, и все порции ставятся в очередь исполнителя вместе.
+/// Каждая порция обрабатывается так же, как при отдельном вызове receive(handle, data, size)
+/// @param chunks указатель на массив порций данных
+/// @param count количество порций
+void receive(const Chunk *chunks, std::size_t count);
+
 /// @brief Отключиться от исполнителя
 /// @param handle контекст
 void disconnect(handle_t handle);
 
+/// @brief Задать параметры обслуживания соединения справедливым планировщиком
+/// @param handle контекст
+/// @param weight вес соединения: доля обслуживания пропорциональна весу
+/// @param priority класс приоритета от 0 (наивысший) до 3, классы обслуживаются строго по порядку
+/// @note Применяется, когда у соединения нет ожидающих исполнения данных
+void schedule(handle_t handle, std::size_t weight, std::size_t priority = 0);
+
+/// @brief Получить количество команд, принятых исполнителем из очереди
+/// @details Команды блока учитываются при его исполнении, одиночные команды - при добавлении в блок
+/// @return количество команд с момента запуска
+std::size_t processed();
+
+/// @brief Дождаться исполнения всех переданных данных и остановить исполнитель
+void shutdown();
+
 }
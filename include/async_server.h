@@ -3,22 +3,112 @@
 /// @file
 /// @brief Файл с объявлением асинхронного сервера
 
+#include "block_pool.h"
+#include "bulk_reader.h"
+#include "command_stream.h"
 #include <boost/asio.hpp>
+#include <atomic>
+#include <memory>
 
 namespace async_server
 {
 
 namespace ba = boost::asio;
 
-/// @brief Класс асинхронного сервера
-class Server
+/// @brief Параметры сервера
+struct Options
+{
+    bool slim_ = false;          ///< Использовать сессии с малым расходом памяти на простаивающее соединение
+    BulkReader::Limits limits_;  ///< Ограничения памяти разбора одного соединения
+    std::size_t accepts_ = 1;    ///< Количество одновременно ожидающих операций приема соединения
+    int backlog_ = ba::socket_base::max_listen_connections; ///< Длина очереди ожидающих приема соединений
+    std::size_t sessionPool_ = 0; ///< Количество сессий, память которых выделяется одним куском и используется повторно
+    bool noDelay_ = false;       ///< Включить TCP_NODELAY для принятых соединений TCP
+    int receiveBuffer_ = 0;      ///< Размер буфера приема принятых соединений, 0 - по умолчанию системы
+    int deferAccept_ = 0;        ///< Принимать соединение TCP только после прихода данных, ожидая не дольше секунд
+    std::size_t weight_ = 1;     ///< Вес соединений в справедливом планировщике исполнителя
+    std::size_t priority_ = 0;   ///< Класс приоритета соединений в справедливом планировщике исполнителя
+};
+
+/// @brief Класс асинхронного сервера потоковых соединений
+/// @tparam Protocol протокол потокового сокета (TCP или сокет домена Unix)
+template<typename Protocol>
+class BasicServer
+{
+public:
+    /// @brief Конструктор
+    /// @details Параметры сокетов устанавливаются один раз на слушающем сокете и наследуются
+    /// принятыми соединениями
+    /// @param io_context asio-контекст
+    /// @param endpoint адрес, на котором будет запущен сервер
+    /// @param options параметры сервера
+    BasicServer(ba::io_context& io_context, const typename Protocol::endpoint& endpoint,
+                const Options& options = Options());
+
+private:
+    void do_accept();
+
+    template<typename Session>
+    std::shared_ptr<Session> makeSession(typename Protocol::socket socket);
+
+    ba::io_context& io_context_;
+    typename Protocol::acceptor acceptor_;
+    const Options options_;
+    std::shared_ptr<BlockPool> sessionPool_;
+};
+
+/// @brief Получить количество сессий, размещенных в куче сверх емкости пулов сессий
+/// @return количество сессий всех серверов
+std::size_t sessionPoolOverflow();
+
+/// @brief Класс асинхронного сервера датаграмм
+/// @details Каждая датаграмма содержит пакет команд. Все датаграммы сервера передаются исполнителю
+/// через один контекст, незавершенный блок датаграммы отбрасывается
+/// @tparam Protocol протокол датаграммного сокета (UDP или сокет домена Unix)
+template<typename Protocol>
+class BasicDatagramServer
 {
 public:
     /// @brief Конструктор
     /// @param io_context asio-контекст
-    /// @param port порт, на котором будет запущен сервер
-    Server(ba::io_context& io_context, std::uint16_t port) :
-        acceptor_(io_context, ba::ip::tcp::endpoint(ba::ip::tcp::v4(), port))
+    /// @param endpoint адрес, на котором будет запущен сервер
+    /// @param options параметры сервера
+    BasicDatagramServer(ba::io_context& io_context, const typename Protocol::endpoint& endpoint,
+                        const Options& options = Options());
+
+    /// @brief Деструктор
+    ~BasicDatagramServer();
+
+    /// @brief Получить количество принятых датаграмм
+    /// @return количество датаграмм всех серверов протокола
+    static std::size_t received()
+    {
+        return received_.load();
+    }
+
+private:
+    void do_receive();
+
+    typename Protocol::socket socket_;
+    const Options options_;
+    static constexpr std::size_t max_length_ = 64 * 1024;
+    std::unique_ptr<char[]> data_;
+    CommandStream stream_;
+
+    static std::atomic<std::size_t> received_;
+};
+
+/// @brief Класс сервера счетчиков
+/// @details На каждое соединение отвечает строкой "commands <N> datagrams <M>" с количеством команд,
+/// принятых исполнителем, и датаграмм, принятых серверами, после чего закрывает соединение
+class StatsServer
+{
+public:
+    /// @brief Конструктор
+    /// @param io_context asio-контекст
+    /// @param endpoint адрес, на котором будет запущен сервер
+    StatsServer(ba::io_context& io_context, const ba::ip::tcp::endpoint& endpoint) :
+        acceptor_(io_context, endpoint)
     {
         do_accept();
     }
@@ -29,4 +119,9 @@ private:
     ba::ip::tcp::acceptor acceptor_;
 };
 
+using Server = BasicServer<ba::ip::tcp>;                                  ///< Сервер TCP
+using LocalServer = BasicServer<ba::local::stream_protocol>;              ///< Сервер потоковых сокетов домена Unix
+using DatagramServer = BasicDatagramServer<ba::ip::udp>;                  ///< Сервер UDP
+using LocalDatagramServer = BasicDatagramServer<ba::local::datagram_protocol>; ///< Сервер датаграммных сокетов домена Unix
+
 } //namespace async_server
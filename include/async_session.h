@@ -3,11 +3,11 @@
 /// @file
 /// @brief Файл с объявлением асинхронной сессии пользователя
 
-#include "async.h"
-#include "bulk.h"
-#include "bulk_reader.h"
+#include "async_server.h"
+#include "command_stream.h"
 #include <boost/asio.hpp>
-#include <sstream>
+#include <atomic>
+#include <iosfwd>
 
 extern std::size_t n; ///< размер блока команд
 
@@ -17,16 +17,28 @@ namespace async_server
 namespace ba = boost::asio;
 
 /// @brief Класс асинхронной сессии
-class Session : public std::enable_shared_from_this<Session>
+/// @tparam Protocol протокол потокового сокета
+template<typename Protocol>
+class BasicSession : public std::enable_shared_from_this<BasicSession<Protocol>>
 {
 public:
+    using socket_type = typename Protocol::socket;
+
     /// @brief Конструктор
     /// @param socket клиентский сокет
-    Session(ba::ip::tcp::socket socket) :
+    /// @param options параметры сервера: ограничения разбора и параметры планировщика
+    BasicSession(socket_type socket, const Options& options = Options()) :
         socket_(std::move(socket)),
-        reader_(is_, n)
+        stream_(n, options.limits_)
     {
-        handle_ = async::connect(n);
+        stream_.schedule(options.weight_, options.priority_);
+        count_++;
+    }
+
+    /// @brief Деструктор
+    ~BasicSession()
+    {
+        count_--;
     }
 
     /// @brief Начать чтение и обработку данных
@@ -35,18 +47,82 @@ public:
         do_read();
     }
 
+    /// @brief Получить количество существующих сессий
+    /// @return количество сессий
+    static std::size_t count()
+    {
+        return count_.load();
+    }
+
 private:
     void do_read();
 
-    ba::ip::tcp::socket socket_;
+    socket_type socket_;
     static constexpr std::size_t max_length_ = 1024;
     char data_[max_length_];
 
-    async::handle_t handle_;
-    Bulk bulk_;
-    std::stringstream is_;
-    BulkReader reader_;
-    BulkReader::State state_ = BulkReader::CLOSED_BULK;
+    CommandStream stream_;
+
+    static std::atomic<std::size_t> count_;
 };
 
+/// @brief Класс асинхронной сессии с малым расходом памяти
+/// @details Ожидает готовности сокета к чтению без буфера, читает данные в буфер из общего пула
+/// и освобождает состояние разбора, пока соединение простаивает
+/// @tparam Protocol протокол потокового сокета
+template<typename Protocol>
+class BasicSlimSession : public std::enable_shared_from_this<BasicSlimSession<Protocol>>
+{
+public:
+    using socket_type = typename Protocol::socket;
+
+    /// @brief Конструктор
+    /// @param socket клиентский сокет
+    /// @param options параметры сервера: ограничения разбора и параметры планировщика
+    BasicSlimSession(socket_type socket, const Options& options = Options()) :
+        socket_(std::move(socket)),
+        stream_(n, options.limits_)
+    {
+        stream_.schedule(options.weight_, options.priority_);
+        count_++;
+    }
+
+    /// @brief Деструктор
+    ~BasicSlimSession()
+    {
+        count_--;
+    }
+
+    /// @brief Начать чтение и обработку данных
+    void start()
+    {
+        socket_.non_blocking(true);
+        do_wait();
+    }
+
+    /// @brief Получить количество существующих сессий
+    /// @return количество сессий
+    static std::size_t count()
+    {
+        return count_.load();
+    }
+
+private:
+    void do_wait();
+
+    socket_type socket_;
+    CommandStream stream_;
+
+    static std::atomic<std::size_t> count_;
+};
+
+using Session = BasicSession<ba::ip::tcp>;                          ///< Сессия TCP
+using SlimSession = BasicSlimSession<ba::ip::tcp>;                  ///< Сессия TCP с малым расходом памяти
+using LocalSession = BasicSession<ba::local::stream_protocol>;         ///< Сессия сокета домена Unix
+using LocalSlimSession = BasicSlimSession<ba::local::stream_protocol>; ///< Сессия сокета домена Unix с малым расходом памяти
+
+/// @brief Вывести статистику расхода памяти сессиями
+/// @param os поток вывода
+void printSessionStats(std::ostream& os);
+
 } //namespace async_server
@@ -0,0 +1,144 @@
+#pragma once
+
+/// @file
+/// @brief Файл с объявлением пула блоков памяти для объектов с частым созданием и удалением
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+/// @brief Класс пула блоков памяти одинакового размера
+/// @details При первом запросе выделяет одним куском capacity блоков размера запроса
+/// и выдает их повторно. Запросы сверх емкости и другого размера обслуживаются кучей
+class BlockPool
+{
+public:
+    /// @brief Конструктор
+    /// @param capacity количество блоков, выделяемых одним куском
+    BlockPool(std::size_t capacity) :
+        capacity_(capacity)
+    {
+    }
+
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+
+    /// @brief Получить блок памяти
+    /// @param size размер блока
+    /// @return указатель на блок
+    void* acquire(std::size_t size)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!slab_ && capacity_)
+            {
+                reserve(size);
+            }
+            if (size == blockSize_ && !free_.empty())
+            {
+                void* block = free_.back();
+                free_.pop_back();
+                return block;
+            }
+            heap_++;
+        }
+        return ::operator new(size);
+    }
+
+    /// @brief Вернуть блок памяти в пул
+    /// @param block указатель на блок
+    void release(void* block)
+    {
+        auto p = static_cast<char*>(block);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (slab_ && p >= slab_.get() && p < slab_.get() + capacity_ * blockSize_)
+            {
+                free_.push_back(block);
+                return;
+            }
+            heap_--;
+        }
+        ::operator delete(block);
+    }
+
+    /// @brief Получить количество блоков, выделенных из кучи сверх емкости пула
+    /// @return количество блоков
+    std::size_t heap() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return heap_;
+    }
+
+private:
+    void reserve(std::size_t size)
+    {
+        constexpr std::size_t align = alignof(std::max_align_t);
+        blockSize_ = (size + align - 1) / align * align;
+        slab_.reset(new char[capacity_ * blockSize_]);
+        free_.reserve(capacity_);
+        for (std::size_t i = capacity_; i > 0; --i)
+        {
+            free_.push_back(slab_.get() + (i - 1) * blockSize_);
+        }
+    }
+
+    const std::size_t capacity_;
+    std::size_t blockSize_ = 0;
+    std::unique_ptr<char[]> slab_;
+    std::vector<void*> free_;
+    std::size_t heap_ = 0;
+    mutable std::mutex mutex_;
+};
+
+/// @brief Распределитель памяти из пула блоков для std::allocate_shared
+/// @details Пул разделяется копиями распределителя и живет, пока существует хотя бы один выделенный объект
+/// @tparam T тип объекта
+template<typename T>
+class PoolAllocator
+{
+public:
+    using value_type = T;
+
+    /// @brief Конструктор
+    /// @param pool пул блоков
+    PoolAllocator(std::shared_ptr<BlockPool> pool) :
+        pool_(std::move(pool))
+    {
+    }
+
+    template<typename U>
+    PoolAllocator(const PoolAllocator<U>& other) :
+        pool_(other.pool_)
+    {
+    }
+
+    T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(pool_->acquire(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, std::size_t)
+    {
+        pool_->release(p);
+    }
+
+    template<typename U>
+    bool operator==(const PoolAllocator<U>& other) const
+    {
+        return pool_ == other.pool_;
+    }
+
+    template<typename U>
+    bool operator!=(const PoolAllocator<U>& other) const
+    {
+        return pool_ != other.pool_;
+    }
+
+private:
+    template<typename U> friend class PoolAllocator;
+
+    std::shared_ptr<BlockPool> pool_;
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+/// @file
+/// @brief Файл с объявлением пула буферов чтения
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/// @brief Класс пула буферов одинакового размера
+/// @details Буферы выдаются на время одной операции и возвращаются в пул,
+/// поэтому их количество определяется числом одновременно выполняемых чтений, а не числом соединений
+class BufferPool
+{
+public:
+    using Buffer = std::unique_ptr<char[]>;
+
+    /// @brief Конструктор
+    /// @param bufferSize размер буфера
+    /// @param maxFree максимальное количество свободных буферов, хранимых в пуле
+    BufferPool(std::size_t bufferSize, std::size_t maxFree) :
+        bufferSize_(bufferSize),
+        maxFree_(maxFree)
+    {
+    }
+
+    /// @brief Получить буфер из пула
+    /// @return буфер размером bufferSize()
+    Buffer acquire()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!free_.empty())
+            {
+                Buffer buffer = std::move(free_.back());
+                free_.pop_back();
+                return buffer;
+            }
+            allocated_++;
+        }
+        return Buffer(new char[bufferSize_]);
+    }
+
+    /// @brief Вернуть буфер в пул
+    /// @param buffer буфер
+    void release(Buffer buffer)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_.size() < maxFree_)
+        {
+            free_.push_back(std::move(buffer));
+        }
+        else
+        {
+            allocated_--;
+        }
+    }
+
+    /// @brief Получить размер буфера
+    /// @return размер буфера
+    std::size_t bufferSize() const
+    {
+        return bufferSize_;
+    }
+
+    /// @brief Получить количество существующих буферов, выданных и свободных
+    /// @return количество буферов
+    std::size_t allocated() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return allocated_;
+    }
+
+private:
+    const std::size_t bufferSize_;
+    const std::size_t maxFree_;
+    mutable std::mutex mutex_;
+    std::vector<Buffer> free_;
+    std::size_t allocated_ = 0;
+};
@@ -8,9 +8,11 @@
 #include <vector>
 
 /// @brief Класс блока команд
-class Bulk : private std::vector<std::string>
+/// @tparam T тип команды
+template<typename T>
+class BasicBulk : private std::vector<T>
 {
-    using vector = std::vector<std::string>;
+    using vector = std::vector<T>;
 public:
     using vector::empty;
     using vector::size;
@@ -19,16 +21,16 @@ public:
     using vector::end;
 
     /// @brief Добавить команду в блок
-    /// @tparam T тип значения команды
+    /// @tparam U тип значения команды
     /// @param str значение команды
-    template<class T>
-    void push_back(T&& str)
+    template<class U>
+    void push_back(U&& str)
     {
         if (empty())
         {
             tp_ = std::chrono::system_clock::now();
         }
-        vector::emplace_back(std::forward<T>(str));
+        vector::emplace_back(std::forward<U>(str));
     }
 
     /// @brief Получить время записи первой команды в блок
@@ -37,3 +39,5 @@ public:
 private:
     TimePoint tp_; ///< Время приема первой команды
 };
+
+using Bulk = BasicBulk<std::string>; ///< Блок команд-строк
@@ -3,11 +3,11 @@
 /// @file
 /// @brief Файл с объявлением класса читателя блока команд
 
+#include "bulk.h"
+#include <atomic>
 #include <memory>
 #include <string>
 
-class Bulk;
-
 /// @brief Класс читателя блока команд
 class BulkReader
 {
@@ -19,12 +19,50 @@ public:
         CLOSED_BULK  ///< Закрытый блок
     };
 
+    /// @brief Действие при превышении ограничения
+    enum Action
+    {
+        FLUSH,    ///< Передать накопленное: часть строки как команду, часть динамического блока как блок
+        TRUNCATE, ///< Отбросить все, что выходит за ограничение
+        CLOSE     ///< Прекратить разбор и закрыть соединение
+    };
+
+    /// @brief Ограничения памяти разбора одного соединения
+    /// @details Нулевое значение снимает ограничение, по умолчанию ограничения выключены.
+    /// Размер блока учитывает память, занимаемую командами в блоке, а не только их текст,
+    /// поэтому при заданных maxLine_ и maxBlockBytes_ память разбора соединения сверх одной порции данных
+    /// не превышает maxBlockBytes_ плюс память одной команды длиной до maxLine_
+    struct Limits
+    {
+        std::size_t maxLine_ = 0;       ///< Максимальная длина строки в байтах
+        std::size_t maxDepth_ = 0;      ///< Максимальная глубина вложенности динамических блоков
+        std::size_t maxBlockBytes_ = 0; ///< Максимальный объем памяти команд динамического блока в байтах
+        Action action_ = FLUSH;         ///< Действие при превышении ограничения
+    };
+
+    /// @brief Количество превышений каждого из ограничений всеми читателями
+    struct Stats
+    {
+        std::size_t line_ = 0;  ///< Превышений длины строки
+        std::size_t depth_ = 0; ///< Превышений глубины вложенности
+        std::size_t block_ = 0; ///< Превышений размера динамического блока
+    };
+
     /// @brief Конструктор класса
     /// @param is входящий поток данных
     /// @param n размер блока
     BulkReader(std::istream& is, std::size_t n) : is_(is), n_(n) { }
 
+    /// @brief Конструктор класса
+    /// @param is входящий поток данных
+    /// @param n размер блока
+    /// @param limits ограничения памяти разбора
+    BulkReader(std::istream& is, std::size_t n, const Limits& limits) :
+        is_(is), n_(n), limits_(limits) { }
+
     /// @brief Прочитать блок команд
+    /// @details При превышении ограничения с действием FLUSH динамический блок возвращается частями,
+    /// оставаясь открытым
     /// @param bulk блок команд
     /// @return есть ли еще команды для чтения
     bool read(Bulk& bulk);
@@ -32,11 +70,44 @@ public:
     /// @brief Получить состояние читателя блока команд
     /// @return состояние читателя блока команд
     State state() const;
+
+    /// @brief Проверить отсутствие незавершенных данных
+    /// @return true, если нет недочитанной строки и открытого блока или false, если есть
+    bool empty() const
+    {
+        return buffer_.empty() && openDepth_ == 0 && !skipLine_ && !continuation_;
+    }
+
+    /// @brief Проверить, прекращен ли разбор из-за превышения ограничения с действием CLOSE
+    /// @return true, если соединение нужно закрыть или false, если нет
+    bool failed() const
+    {
+        return failed_;
+    }
+
+    /// @brief Получить количество превышений ограничений
+    /// @return количество превышений каждого из ограничений
+    static Stats stats();
+
 private:
     void ltrim(std::string& str) const;
+    bool exceeded(std::atomic<std::size_t>& counter);
+    bool brace(char ch);
+    static std::size_t footprint(const std::string& cmd);
 
     std::istream& is_;
     const std::size_t n_ = 0;
+    const Limits limits_{};
     size_t openDepth_ = 0;
+    size_t ignoredDepth_ = 0;
+    std::size_t blockBytes_ = 0;
+    bool skipLine_ = false;
+    bool continuation_ = false;
+    bool truncatingBlock_ = false;
+    bool failed_ = false;
     std::string buffer_;
+
+    static std::atomic<std::size_t> lineExceeded_;
+    static std::atomic<std::size_t> depthExceeded_;
+    static std::atomic<std::size_t> blockExceeded_;
 };
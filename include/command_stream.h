@@ -0,0 +1,95 @@
+#pragma once
+
+/// @file
+/// @brief Файл с объявлением потока команд одного соединения
+
+#include "async.h"
+#include "bulk.h"
+#include "bulk_reader.h"
+#include <atomic>
+#include <memory>
+#include <sstream>
+
+/// @brief Класс потока команд одного соединения
+/// @details Разбирает поступающие данные на команды и передает их исполнителю блоков команд
+class CommandStream
+{
+public:
+    /// @brief Конструктор
+    /// @param n размер блока команд
+    /// @param limits ограничения памяти разбора
+    CommandStream(std::size_t n, const BulkReader::Limits& limits = BulkReader::Limits()) :
+        n_(n),
+        limits_(limits)
+    {
+        handle_ = async::connect(n);
+    }
+
+    CommandStream(const CommandStream&) = delete;
+    CommandStream& operator=(const CommandStream&) = delete;
+
+    /// @brief Передать очередную порцию данных соединения
+    /// @param data указатель на буфер данных
+    /// @param size размер буфера
+    /// @return false, если превышено ограничение разбора с действием CLOSE и соединение нужно закрыть
+    bool feed(const char* data, std::size_t size);
+
+    /// @brief Задать параметры обслуживания потока справедливым планировщиком
+    /// @param weight вес потока
+    /// @param priority класс приоритета потока
+    void schedule(std::size_t weight, std::size_t priority)
+    {
+        async::schedule(handle_, weight, priority);
+    }
+
+    /// @brief Освободить состояние разбора, если нет незавершенных данных
+    /// @details Состояние будет создано заново при следующей порции данных
+    /// @return true, если состояние освобождено или false, если нет
+    bool release();
+
+    /// @brief Отбросить незавершенные данные: недочитанную строку и открытый блок
+    void reset()
+    {
+        parser_.reset();
+        state_ = BulkReader::CLOSED_BULK;
+    }
+
+    /// @brief Завершить поток команд
+    void close();
+
+    /// @brief Получить количество существующих состояний разбора всех потоков
+    /// @return количество состояний разбора
+    static std::size_t parsers()
+    {
+        return parsers_.load();
+    }
+
+    /// @brief Получить размер состояния разбора без учета динамических буферов
+    /// @return размер в байтах
+    static constexpr std::size_t parserSize();
+
+private:
+    /// @brief Состояние разбора
+    struct Parser
+    {
+        Parser(std::size_t n, const BulkReader::Limits& limits) : reader_(is_, n, limits) { parsers_++; }
+        ~Parser() { parsers_--; }
+
+        Bulk bulk_;
+        std::stringstream is_;
+        BulkReader reader_;
+    };
+
+    const std::size_t n_;
+    const BulkReader::Limits limits_;
+    async::handle_t handle_;
+    std::unique_ptr<Parser> parser_;
+    BulkReader::State state_ = BulkReader::CLOSED_BULK;
+
+    static std::atomic<std::size_t> parsers_;
+};
+
+constexpr std::size_t CommandStream::parserSize()
+{
+    return sizeof(Parser);
+}
@@ -3,6 +3,7 @@
 /// @file
 /// @brief Файл с объявлением многопоточной очереди
 
+#include "wait_strategy.h"
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
@@ -44,6 +45,36 @@ public:
             return false;
         }
         queue_.push(std::forward<U>(item));
+        count_.store(queue_.size(), std::memory_order_relaxed);
+        lock.unlock();
+
+        cond_.notify_all();
+        return true;
+    }
+
+    /// @brief Вставить элементы в конец очереди за одну блокировку с ожиданием, если очередь переполнена
+    /// @tparam It тип итератора элементов
+    /// @param first начало диапазона элементов
+    /// @param last конец диапазона элементов
+    /// @return true, если все элементы вставлены или false, если очередь заблокирована
+    template<typename It>
+    bool waitPushRange(It first, It last)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (; first != last; ++first)
+        {
+            while (queue_.size() >= maxSize_.load() && !disabled_.load())
+            {
+                cond_.notify_all(); // потребитель должен освободить место для оставшихся элементов
+                cond_.wait(lock);
+            }
+            if (disabled_.load())
+            {
+                return false;
+            }
+            queue_.push(*first);
+            count_.store(queue_.size(), std::memory_order_relaxed);
+        }
         lock.unlock();
 
         cond_.notify_all();
@@ -55,6 +86,8 @@ public:
     /// @return true, если элемент получен или false, если очередь заблокирована
     bool waitPop(T& item)
     {
+        spinWait(strategy_, [this]{ return count_.load(std::memory_order_relaxed) || disabled_.load(); });
+
         std::unique_lock<std::mutex> lock(mutex_);
         while (queue_.empty() && !disabled_.load())
         {
@@ -66,6 +99,7 @@ public:
         }
         item = std::move(queue_.front());
         queue_.pop();
+        count_.store(queue_.size(), std::memory_order_relaxed);
         lock.unlock();
 
         cond_.notify_all();
@@ -95,6 +129,7 @@ public:
             return false;
         }
         queue_.push(std::forward<U>(item));
+        count_.store(queue_.size(), std::memory_order_relaxed);
         lock.unlock();
 
         cond_.notify_all();
@@ -124,12 +159,21 @@ public:
         }
         item = queue_.front();
         queue_.pop();
+        count_.store(queue_.size(), std::memory_order_relaxed);
         lock.unlock();
 
         cond_.notify_all();
         return true;
     }
 
+    /// @brief Задать стратегию ожидания элементов потребителем
+    /// @param strategy стратегия ожидания
+    /// @note Задается до начала использования очереди
+    void setWaitStrategy(const WaitStrategy& strategy)
+    {
+        strategy_ = strategy;
+    }
+
     /// @brief Изменить максимальный размер очереди
     /// @param maxSize максимальный размер очереди
     void setMaxSize(std::size_t maxSize)
@@ -149,6 +193,7 @@ public:
             {
                 queue_.pop();
             }
+            count_.store(0);
         }
         cond_.notify_all();
     }
@@ -173,4 +218,6 @@ private:
     std::condition_variable cond_;
     std::mutex mutex_;
     std::atomic_bool disabled_{false};
+    std::atomic<std::size_t> count_{0}; ///< Размер очереди для проверки без блокировки
+    WaitStrategy strategy_;
 };
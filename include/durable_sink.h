@@ -0,0 +1,91 @@
+#pragma once
+
+/// @file
+/// @brief Файл с объявлением приемника данных в файл с групповой фиксацией на диск
+
+#include "logger.h"
+#include "thread.h"
+#include <condition_variable>
+#include <ctime>
+#include <map>
+#include <mutex>
+
+namespace logging
+{
+
+/// @brief Класс приемника данных в файл с групповой фиксацией на диск
+/// @details Блоки от всех соединений накапливаются и записываются отдельным потоком
+/// одной группой, после чего выполняется один fdatasync на каждый затронутый файл.
+/// Фиксация выполняется по истечении интервала или при накоплении заданного объема данных.
+/// Если фиксация не успевает и ожидающих данных накопилось больше лимита, запись блокируется до ее завершения.
+class DurableFileSink : public BaseSink
+{
+public:
+    /// @brief Статистика фиксаций
+    struct Stats
+    {
+        std::size_t commits_ = 0; ///< Количество фиксаций
+        std::size_t bulks_ = 0;   ///< Количество зафиксированных блоков
+        std::size_t bytes_ = 0;   ///< Количество зафиксированных байт
+        std::size_t failedBulks_ = 0; ///< Количество блоков, запись или фиксация которых не удалась
+        std::size_t failedBytes_ = 0; ///< Количество байт, запись или фиксация которых не удалась
+        std::size_t stalls_ = 0;  ///< Количество блокировок записи из-за лимита ожидающих данных
+        std::chrono::microseconds totalLatency_{0}; ///< Суммарная задержка фиксации
+        std::chrono::microseconds maxLatency_{0};   ///< Максимальная задержка фиксации
+    };
+
+    /// @brief Конструктор
+    /// @param interval интервал групповой фиксации
+    /// @param bytes объем данных, при накоплении которого фиксация выполняется досрочно
+    /// @param maxPending объем ожидающих фиксации данных, при котором запись блокируется
+    /// @param cpus процессоры потока фиксации
+    DurableFileSink(std::chrono::milliseconds interval, std::size_t bytes, std::size_t maxPending,
+                    CpuSet cpus = CpuSet());
+
+    /// @brief Деструктор
+    /// @details Фиксирует накопленные данные и выводит статистику фиксаций
+    ~DurableFileSink() override;
+
+    /// @brief Записать в приемник
+    /// @param msg сообщение
+    void write(const Message& msg) override;
+
+    /// @brief Записать в приемник без виртуального вызова
+    /// @param msg сообщение
+    void write(const MessageView& msg)
+    {
+        write(Message{std::string(msg.text_), msg.tp_});
+    }
+
+    /// @brief Получить статистику фиксаций
+    /// @return статистика фиксаций
+    Stats stats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void commitLoop();
+    void commit(const std::vector<Message>& batch, Clock::time_point first);
+    int file(std::time_t t);
+    /// @brief Зафиксировать на диске записи текущего каталога
+    /// @return true, если каталог зафиксирован
+    static bool syncDirectory();
+
+    const std::chrono::milliseconds interval_;
+    const std::size_t bytes_;
+    const std::size_t maxPending_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cond_;
+    std::condition_variable space_; ///< Сигнал об освобождении места для заблокированной записи
+    std::vector<Message> pending_;   ///< Блоки, ожидающие фиксации
+    std::size_t pendingBytes_ = 0;   ///< Объем блоков, ожидающих фиксации
+    Clock::time_point first_;        ///< Время поступления первого ожидающего блока
+    bool stopped_ = false;
+    Stats stats_;
+
+    std::map<std::time_t, int> files_; ///< Открытые файлы, используется только потоком фиксации
+    Thread thread_;
+};
+
+} //namespace logging
@@ -5,35 +5,52 @@
 
 #include "bulk.h"
 #include "logger.h"
-#include <numeric>
+#include "trace.h"
+#include <string>
 
 /// @brief Класс исполнителя блока команд
-class Executor
+/// @details Блок сериализуется в буфер исполнителя, который переиспользуется между блоками,
+/// а логгер получает текст без копирования
+/// @tparam Logger тип логгера: logging::Logger или logging::StaticLogger
+template<typename Logger>
+class BasicExecutor
 {
 public:
     /// @brief Конструктор класса
     /// @param logger логгер объекта
-    Executor(logging::Logger& logger) : logger_(logger) { }
+    BasicExecutor(Logger& logger) : logger_(logger) { }
 
     /// @brief Исполнить блок команд
+    /// @tparam T тип команды, приводимый к std::string_view
     /// @param bulk блок команд
-    void exec(Bulk& bulk) const
+    template<typename T>
+    void exec(BasicBulk<T>& bulk) const
     {
         if (!bulk.empty())
         {
-            logger_.write({serialize(bulk), bulk.time()});
+            serialize(bulk);
+            logger_.write(logging::MessageView{buffer_, bulk.time()});
         }
     }
 private:
-    std::string serialize(const Bulk& bulk) const
+    template<typename T>
+    void serialize(const BasicBulk<T>& bulk) const
     {
-        std::string s = std::accumulate(std::begin(bulk), std::end(bulk), std::string(),
-            [](const std::string &ss, const std::string &s)
+        TRACE_SCOPE("Executor::serialize");
+        static const std::string prefix = "bulk: ";
+        buffer_.assign(prefix);
+        for (const auto& cmd : bulk)
+        {
+            if (buffer_.size() != prefix.size())
             {
-                return ss.empty() ? s : ss + ", " + s;
-            });
-        return "bulk: " + s;
+                buffer_.append(", ");
+            }
+            buffer_.append(std::string_view(cmd));
+        }
     }
 
-    logging::Logger& logger_; ///< Логгер
+    Logger& logger_; ///< Логгер
+    mutable std::string buffer_; ///< Буфер сериализованного блока
 };
+
+using Executor = BasicExecutor<logging::Logger>; ///< Исполнитель с набором приемников, задаваемым во время исполнения
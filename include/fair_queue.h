@@ -0,0 +1,219 @@
+#pragma once
+
+/// @file
+/// @brief Файл с объявлением многопоточной очереди со справедливым обслуживанием потоков элементов
+
+#include "wait_strategy.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+/// @brief Класс многопоточной очереди со справедливым обслуживанием потоков элементов
+/// @details Элементы каждого потока (соединения) хранятся в отдельной подочереди.
+/// Подочереди обслуживаются по алгоритму deficit round robin со стоимостью элемента в байтах:
+/// за один обход поток получает квант, пропорциональный своему весу, и может изъять элементы на эту сумму.
+/// Классы приоритета обслуживаются строго по порядку: класс 0 — наивысший.
+/// Очередь не ограничена по размеру, поэтому вставка не ожидает.
+/// @tparam Key тип ключа потока элементов
+/// @tparam T тип элементов очереди
+template<typename Key, typename T>
+class FairQueue
+{
+public:
+    /// @brief Конструктор
+    /// @param quantum квант обслуживания потока с весом 1 в байтах
+    /// @param classes количество классов приоритета
+    FairQueue(std::size_t quantum = 1024, std::size_t classes = 4) :
+        quantum_(std::max<std::size_t>(quantum, 1)),
+        active_(std::max<std::size_t>(classes, 1))
+    {
+    }
+
+    /// @brief Вставить элемент в конец подочереди потока
+    /// @tparam U тип элемента
+    /// @param key ключ потока
+    /// @param item элемент
+    /// @param cost стоимость элемента в байтах
+    /// @param weight вес потока, учитывается при появлении у потока элементов
+    /// @param priority класс приоритета потока, учитывается при появлении у потока элементов
+    /// @return true, если элемент вставлен или false, если очередь заблокирована
+    template<typename U>
+    bool push(const Key& key, U&& item, std::size_t cost, std::size_t weight = 1, std::size_t priority = 0)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (disabled_.load())
+        {
+            return false;
+        }
+        pushLocked(key, std::forward<U>(item), cost, weight, priority);
+        lock.unlock();
+
+        cond_.notify_all();
+        return true;
+    }
+
+    /// @brief Элемент для пакетной вставки
+    struct Entry
+    {
+        Key key_;                  ///< Ключ потока
+        T item_;                   ///< Элемент
+        std::size_t cost_ = 1;     ///< Стоимость элемента в байтах
+        std::size_t weight_ = 1;   ///< Вес потока
+        std::size_t priority_ = 0; ///< Класс приоритета потока
+    };
+
+    /// @brief Вставить элементы в подочереди их потоков за одну блокировку
+    /// @param entries элементы
+    /// @return true, если элементы вставлены или false, если очередь заблокирована
+    bool push(std::vector<Entry>&& entries)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (disabled_.load())
+        {
+            return false;
+        }
+        for (auto& entry : entries)
+        {
+            pushLocked(entry.key_, std::move(entry.item_), entry.cost_, entry.weight_, entry.priority_);
+        }
+        lock.unlock();
+
+        cond_.notify_all();
+        return true;
+    }
+
+    /// @brief Изъять очередной элемент с ожиданием, если очередь пуста
+    /// @param item элемент
+    /// @return true, если элемент получен или false, если очередь заблокирована и пуста
+    bool waitPop(T& item)
+    {
+        spinWait(strategy_, [this]{ return size_.load(std::memory_order_relaxed) || disabled_.load(); });
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (size_ == 0 && !disabled_.load())
+        {
+            cond_.wait(lock);
+        }
+        if (size_ == 0)
+        {
+            return false;
+        }
+
+        auto active = std::find_if(active_.begin(), active_.end(), [](const auto& keys){ return !keys.empty(); });
+        auto& keys = *active;
+        while (true)
+        {
+            auto it = flows_.find(keys.front());
+            auto& flow = it->second;
+            auto cost = flow.items_.front().second;
+            if (!flow.credited_)
+            {
+                // Единственному активному потоку нет смысла копить квант за несколько обходов
+                flow.deficit_ += keys.size() == 1 ? std::max(flow.quantum_, cost) : flow.quantum_;
+                flow.credited_ = true;
+            }
+            if (cost <= flow.deficit_)
+            {
+                flow.deficit_ -= cost;
+                item = std::move(flow.items_.front().first);
+                flow.items_.pop();
+                size_--;
+                if (flow.items_.empty())
+                {
+                    keys.pop_front();
+                    flows_.erase(it);
+                }
+                return true;
+            }
+            flow.credited_ = false;
+            keys.push_back(keys.front());
+            keys.pop_front();
+        }
+    }
+
+    /// @brief Изменить квант обслуживания
+    /// @param quantum квант обслуживания потока с весом 1 в байтах
+    void setQuantum(std::size_t quantum)
+    {
+        quantum_.store(std::max<std::size_t>(quantum, 1));
+    }
+
+    /// @brief Задать стратегию ожидания элементов потребителем
+    /// @param strategy стратегия ожидания
+    /// @note Задается до начала использования очереди
+    void setWaitStrategy(const WaitStrategy& strategy)
+    {
+        strategy_ = strategy;
+    }
+
+    /// @brief Заблокировать очередь
+    /// @param force заблокировать с очищением имеющихся элементов
+    void disable(bool force = false)
+    {
+        disabled_.store(true);
+        if (force)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            flows_.clear();
+            for (auto& keys : active_)
+            {
+                keys.clear();
+            }
+            size_ = 0;
+        }
+        cond_.notify_all();
+    }
+
+    /// @brief Проверить заблокирована ли очередь
+    /// @return true, если заблокирована или false, если нет
+    bool isDisabled() const
+    {
+        return disabled_.load();
+    }
+
+    /// @brief Проверить отсутствие элементов в очереди
+    /// @return true, если элементов нет или false, если есть
+    bool empty()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return size_ == 0;
+    }
+private:
+    template<typename U>
+    void pushLocked(const Key& key, U&& item, std::size_t cost, std::size_t weight, std::size_t priority)
+    {
+        auto& flow = flows_[key];
+        if (flow.items_.empty())
+        {
+            flow.quantum_ = quantum_.load() * std::max<std::size_t>(weight, 1);
+            flow.priority_ = std::min(priority, active_.size() - 1);
+            active_[flow.priority_].push_back(key);
+        }
+        flow.items_.emplace(std::forward<U>(item), std::max<std::size_t>(cost, 1));
+        size_++;
+    }
+
+    /// @brief Подочередь потока элементов
+    struct Flow
+    {
+        std::queue<std::pair<T, std::size_t>> items_; ///< Элементы и их стоимость
+        std::size_t deficit_ = 0;  ///< Накопленный остаток кванта
+        std::size_t quantum_ = 0;  ///< Квант обслуживания за обход
+        std::size_t priority_ = 0; ///< Класс приоритета
+        bool credited_ = false;    ///< Квант текущего обхода уже начислен
+    };
+
+    std::atomic<std::size_t> quantum_{0};
+    std::unordered_map<Key, Flow> flows_;
+    std::vector<std::deque<Key>> active_; ///< Очереди активных потоков по классам приоритета
+    std::atomic<std::size_t> size_{0}; ///< Количество элементов, доступно для проверки без блокировки
+    std::condition_variable cond_;
+    std::mutex mutex_;
+    std::atomic_bool disabled_{false};
+    WaitStrategy strategy_;
+};
@@ -0,0 +1,121 @@
+#pragma once
+
+/// @file
+/// @brief Файл с объявлением приемника данных, пересылающего блоки сборщику
+
+#include "logger.h"
+#include "thread.h"
+#include <boost/asio.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+
+namespace logging
+{
+
+namespace ba = boost::asio;
+
+/// @brief Класс приемника данных, пересылающего блоки сборщику по постоянному соединению
+/// @details Блоки упаковываются в пакеты, пакет передается кадром [длина u32][блоки через '\n'].
+/// Сборщик подтверждает кадры, отправляя накопительное количество принятых кадров соединения (u64).
+/// Одной записью отправляется несколько пакетов, и до подтверждения в полете может находиться
+/// заданное количество пакетов. Неподтвержденные пакеты отправляются повторно после переподключения.
+/// Пакеты сверх лимита памяти, в том числе пока сборщик недоступен, сбрасываются в файл на диске
+/// и отправляются из него после восстановления соединения. Лимит памяти учитывает и пакеты,
+/// переданные потоку пересылки, но еще не обработанные им: если поток отстает, запись блокируется.
+class ForwardSink : public BaseSink
+{
+public:
+    /// @brief Параметры пересылки
+    struct Settings
+    {
+        std::string address_;                       ///< Адрес сборщика: host:port или unix:/path
+        std::size_t batchBytes_ = 64 * 1024;        ///< Размер пакета блоков
+        std::size_t inFlight_ = 4;                  ///< Максимальное количество неподтвержденных пакетов
+        std::size_t bufferBytes_ = 64 * 1024 * 1024; ///< Лимит памяти под ожидающие пакеты
+        std::string spill_ = "bulk_forward.spill";  ///< Файл для пакетов сверх лимита памяти
+        std::chrono::milliseconds interval_{10};    ///< Интервал отправки неполного пакета
+    };
+
+    /// @brief Конструктор
+    /// @param settings параметры пересылки
+    /// @param cpus процессоры потока пересылки
+    /// @throw std::invalid_argument при неверном адресе сборщика
+    ForwardSink(const Settings& settings, CpuSet cpus = CpuSet());
+
+    /// @brief Деструктор
+    /// @details Пытается доставить ожидающие пакеты, недоставленные сбрасывает в файл и выводит статистику
+    ~ForwardSink() override;
+
+    /// @brief Записать в приемник
+    /// @param msg сообщение
+    void write(const Message& msg) override
+    {
+        write(MessageView{msg.text_, msg.tp_});
+    }
+
+    /// @brief Записать в приемник без виртуального вызова
+    /// @param msg сообщение
+    void write(const MessageView& msg);
+
+private:
+    using protocol = ba::generic::stream_protocol;
+
+    void tick();
+    void flushCurrent();
+    void enqueue(std::string batch);
+    void connect();
+    void readAcks(std::size_t generation);
+    void pump();
+    void fail(const boost::system::error_code& ec);
+    void spill(const std::string& batch);
+    void unspill();
+    void finish();
+    void spillAll();
+    void released();
+
+    const Settings settings_;
+    protocol::endpoint endpoint_;
+
+    std::mutex mutex_;
+    std::condition_variable released_; ///< Сигнал об освобождении памяти для ожидающей записи
+    std::string current_; ///< Заполняемый пакет, защищен mutex_
+    std::atomic<std::size_t> postedBytes_{0}; ///< Пакеты, переданные потоку пересылки и еще не обработанные
+    std::atomic<std::size_t> memoryBytes_{0}; ///< Пакеты в памяти потока пересылки: ожидающие и в полете
+
+    // Остальные поля используются только потоком пересылки
+    ba::io_context io_;
+    ba::executor_work_guard<ba::io_context::executor_type> work_;
+    protocol::socket socket_;
+    ba::steady_timer timer_;
+    ba::steady_timer reconnectTimer_;
+    ba::steady_timer graceTimer_;
+    std::chrono::milliseconds backoff_;
+    std::size_t generation_ = 0;  ///< Номер соединения, чтобы отбрасывать результаты операций закрытых соединений
+    bool connected_ = false;
+    bool writing_ = false;
+    bool closing_ = false;
+
+    std::deque<std::string> pending_;  ///< Пакеты, ожидающие отправки
+    std::deque<std::string> inflight_; ///< Отправленные неподтвержденные пакеты
+    std::vector<std::uint32_t> headers_;
+    std::uint64_t ack_ = 0;
+    std::uint64_t acked_ = 0;
+
+    std::ofstream spillOut_;
+    std::ifstream spillIn_;
+    std::uint64_t spillSize_ = 0;
+    std::uint64_t spillRead_ = 0;
+
+    std::size_t sentBatches_ = 0;
+    std::size_t sentBytes_ = 0;
+    std::size_t reconnects_ = 0;
+    std::size_t spilledBytes_ = 0;
+    std::size_t droppedBytes_ = 0;
+
+    Thread thread_;
+};
+
+} //namespace logging
@@ -0,0 +1,179 @@
+#pragma once
+
+/// @file
+/// @brief Файл с объявлением таблицы интернирования команд
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+class Command;
+
+/// @brief Класс таблицы интернирования команд
+/// @details Хранит по одному неизменяемому экземпляру каждой часто встречающейся команды.
+/// Таблица разделена на сегменты с отдельными блокировками, в каждом сегменте ограниченного размера
+/// вытесняется давно не использованная команда. Вытеснение не затрагивает уже выданные команды
+class Interner
+{
+public:
+    /// @brief Экземпляр команды
+    /// @details Заголовок и текст размещаются одним блоком памяти, время жизни определяется счетчиком ссылок
+    class Entry
+    {
+    public:
+        Entry(const Entry&) = delete;
+        Entry& operator=(const Entry&) = delete;
+
+        /// @brief Создать экземпляр команды
+        /// @param text текст команды
+        /// @param id номер команды в таблице или 0 для команды вне таблицы
+        /// @return экземпляр с одной ссылкой
+        static Entry* create(std::string_view text, std::uint32_t id);
+
+        /// @brief Получить текст команды
+        /// @return текст команды
+        std::string_view text() const
+        {
+            return {reinterpret_cast<const char*>(this + 1), size_};
+        }
+
+        /// @brief Получить номер команды
+        /// @return номер команды в таблице или 0 для команды вне таблицы
+        std::uint32_t id() const
+        {
+            return id_;
+        }
+
+    private:
+        friend class ::Command;
+
+        Entry(std::size_t size, std::uint32_t id) : id_(id), size_(size) { }
+
+        void acquire() const
+        {
+            refs_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void release() const;
+
+        mutable std::atomic<std::uint32_t> refs_{1};
+        std::uint32_t id_ = 0;
+        std::size_t size_ = 0;
+    };
+
+    /// @brief Статистика таблицы
+    struct Stats
+    {
+        std::size_t entries_ = 0;   ///< Количество команд в таблице
+        std::size_t hits_ = 0;      ///< Количество найденных команд
+        std::size_t misses_ = 0;    ///< Количество добавленных команд
+        std::size_t evictions_ = 0; ///< Количество вытесненных команд
+        std::size_t savedBytes_ = 0; ///< Объем текста найденных команд, который иначе был бы скопирован в кучу
+    };
+
+    /// @brief Конструктор
+    /// @param capacity максимальное количество команд в таблице
+    /// @param maxLength максимальная длина интернируемой команды
+    Interner(std::size_t capacity, std::size_t maxLength);
+
+    /// @brief Получить команду из таблицы
+    /// @details Команда длиннее допустимой создается вне таблицы
+    /// @param text текст команды
+    /// @return команда
+    Command intern(std::string_view text);
+
+    /// @brief Получить статистику таблицы
+    /// @return статистика таблицы
+    Stats stats() const;
+
+private:
+    static constexpr std::size_t shardCount_ = 16;
+
+    /// @brief Сегмент таблицы
+    struct Shard
+    {
+        using Lru = std::list<Command>;
+
+        mutable std::mutex mutex_;
+        Lru lru_; ///< Команды от недавно использованных к давно не использованным
+        std::unordered_map<std::string_view, Lru::iterator> map_; ///< Ключи указывают на текст команд в lru_
+        std::size_t hits_ = 0;
+        std::size_t misses_ = 0;
+        std::size_t evictions_ = 0;
+        std::size_t savedBytes_ = 0;
+    };
+
+    const std::size_t shardCapacity_;
+    const std::size_t maxLength_;
+    std::atomic<std::uint32_t> nextId_{1};
+    std::array<Shard, shardCount_> shards_;
+};
+
+/// @brief Класс команды исполнителя с интернированием
+/// @details Занимает один указатель на неразделяемый экземпляр или экземпляр из таблицы интернирования
+class Command
+{
+public:
+    Command() = default;
+
+    /// @brief Конструктор команды вне таблицы интернирования
+    /// @param text текст команды
+    Command(std::string_view text) : entry_(text.empty() ? nullptr : Interner::Entry::create(text, 0)) { }
+
+    /// @brief Конструктор команды вне таблицы интернирования
+    /// @param text текст команды
+    Command(const std::string& text) : Command(std::string_view(text)) { }
+
+    Command(const Command& other) : entry_(other.entry_)
+    {
+        if (entry_)
+        {
+            entry_->acquire();
+        }
+    }
+
+    Command(Command&& other) noexcept : entry_(other.entry_)
+    {
+        other.entry_ = nullptr;
+    }
+
+    Command& operator=(Command other) noexcept
+    {
+        std::swap(entry_, other.entry_);
+        return *this;
+    }
+
+    ~Command()
+    {
+        if (entry_)
+        {
+            entry_->release();
+        }
+    }
+
+    /// @brief Получить текст команды
+    /// @return текст команды
+    operator std::string_view() const
+    {
+        return entry_ ? entry_->text() : std::string_view();
+    }
+
+    /// @brief Получить номер интернированной команды
+    /// @return номер команды или 0, если команда не интернирована
+    std::uint32_t id() const
+    {
+        return entry_ ? entry_->id() : 0;
+    }
+
+private:
+    friend class Interner;
+
+    explicit Command(const Interner::Entry* entry) : entry_(entry) { }
+
+    const Interner::Entry* entry_ = nullptr;
+};
@@ -4,9 +4,13 @@
 /// @brief Файл с объявлением логгера и приемников данных
 
 #include "timepoint.h"
+#include "trace.h"
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <string_view>
+#include <tuple>
+#include <typeinfo>
 #include <vector>
 
 namespace logging
@@ -19,6 +23,13 @@ struct Message
     TimePoint tp_ = TimePoint(); ///< Время сообщения
 };
 
+/// @brief Структура сообщения логгера, не владеющего текстом
+struct MessageView
+{
+    std::string_view text_; ///< Текст сообщения
+    TimePoint tp_ = TimePoint(); ///< Время сообщения
+};
+
 /// @brief Базовый класс приемника данных
 class BaseSink
 {
@@ -38,6 +49,13 @@ public:
     /// @brief Записать в приемник
     /// @param msg сообщение
     void write(const Message& msg) override
+    {
+        write(MessageView{msg.text_, msg.tp_});
+    }
+
+    /// @brief Записать в приемник без виртуального вызова
+    /// @param msg сообщение
+    void write(const MessageView& msg)
     {
         std::cout << msg.text_ << std::endl;
     }
@@ -50,6 +68,13 @@ public:
     /// @brief Записать в приемник
     /// @param msg сообщение
     void write(const Message& msg) override
+    {
+        write(MessageView{msg.text_, msg.tp_});
+    }
+
+    /// @brief Записать в приемник без виртуального вызова
+    /// @param msg сообщение
+    void write(const MessageView& msg)
     {
         auto t = std::chrono::system_clock::to_time_t(msg.tp_);
         auto fileName = "bulk" + std::to_string(t) + ".log";
@@ -68,10 +93,18 @@ public:
     {
         for (const auto& sink : sinks_)
         {
+            TRACE_SCOPE("BaseSink::write", typeid(*sink).name());
             sink->write(msg);
         }
     }
 
+    /// @brief Записать в лог
+    /// @param msg сообщение, текст которого копируется для приемников
+    void write(const MessageView& msg)
+    {
+        write(Message{std::string(msg.text_), msg.tp_});
+    }
+
     /// @brief Добавить приемник данных к логгеру
     /// @param sink приемник данных
     void addSink(std::unique_ptr<BaseSink> sink)
@@ -82,4 +115,44 @@ private:
     std::vector<std::unique_ptr<BaseSink>> sinks_; ///< Набор приемников данных
 };
 
+/// @brief Класс логгера с набором приемников, заданным на этапе компиляции
+/// @details Приемники вызываются напрямую, без виртуальной диспетчеризации, и получают текст сообщения
+/// без копирования. Каждый приемник должен иметь метод write(const MessageView&)
+/// @tparam Sinks типы приемников данных
+template<typename... Sinks>
+class StaticLogger
+{
+public:
+    /// @brief Конструктор
+    /// @tparam Args типы аргументов конструкторов приемников
+    /// @param args аргументы конструкторов приемников, по одному на приемник
+    template<typename... Args>
+    explicit StaticLogger(Args&&... args) : sinks_(std::forward<Args>(args)...) { }
+
+    /// @brief Записать в лог
+    /// @param msg сообщение
+    void write(const MessageView& msg)
+    {
+        std::apply([&msg](auto&... sinks){ (write(sinks, msg), ...); }, sinks_);
+    }
+
+    /// @brief Получить приемник данных
+    /// @tparam Sink тип приемника
+    /// @return приемник данных
+    template<typename Sink>
+    Sink& sink()
+    {
+        return std::get<Sink>(sinks_);
+    }
+private:
+    template<typename Sink>
+    static void write(Sink& sink, const MessageView& msg)
+    {
+        TRACE_SCOPE("BaseSink::write", typeid(Sink).name());
+        sink.write(msg);
+    }
+
+    std::tuple<Sinks...> sinks_; ///< Набор приемников данных
+};
+
 } //namespace logging
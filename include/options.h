@@ -0,0 +1,148 @@
+#pragma once
+
+/// @file
+/// @brief Файл с объявлением параметров командной строки исполнителя блоков команд
+
+#include "async.h"
+#include "bulk_reader.h"
+#include "thread.h"
+#include "trace.h"
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+
+/// @brief Получить описание параметров командной строки исполнителя блоков команд
+/// @param options параметры исполнителя, заполняемые при разборе командной строки
+/// @return описание параметров
+inline po::options_description asyncOptions(async::Options& options)
+{
+    po::options_description desc("Executor options");
+    desc.add_options()
+        ("durable", po::bool_switch(&options.durable_),
+            "write bulks to files with group commit (one fdatasync per interval or byte threshold)")
+        ("commit-interval", po::value<std::size_t>()->default_value(options.commitInterval_.count())
+            ->notifier([&options](std::size_t ms)
+                {
+                    if (ms < 1)
+                    {
+                        throw std::invalid_argument("commit-interval must be positive");
+                    }
+                    options.commitInterval_ = std::chrono::milliseconds(ms);
+                }),
+            "group commit interval, ms")
+        ("commit-bytes", po::value<std::size_t>(&options.commitBytes_)->default_value(options.commitBytes_)
+            ->notifier([](std::size_t bytes)
+                {
+                    if (bytes < 1)
+                    {
+                        throw std::invalid_argument("commit-bytes must be positive");
+                    }
+                }),
+            "bytes accumulated before an early group commit")
+        ("commit-max-pending", po::value<std::size_t>(&options.commitMaxPending_)->default_value(options.commitMaxPending_),
+            "bytes waiting for a group commit before writers block until it completes")
+        ("executor-cpus", po::value<std::string>()
+            ->notifier([&options](const std::string& list){ options.executorCpus_ = parseCpuList(list); }),
+            "CPUs of the executor thread, e.g. 0-3,8")
+        ("sink-cpus", po::value<std::string>()
+            ->notifier([&options](const std::string& list){ options.sinkCpus_ = parseCpuList(list); }),
+            "CPUs of the sink threads")
+        ("fair", po::bool_switch(&options.fair_),
+            "serve connections with deficit round robin by bytes instead of one FIFO")
+        ("fair-quantum", po::value<std::size_t>(&options.fairQuantum_)->default_value(options.fairQuantum_),
+            "bytes served per connection per round, multiplied by the connection weight")
+        ("no-files", po::bool_switch()->notifier([&options](bool off){ options.files_ = !off; }),
+            "do not write bulk*.log files (unless --durable)")
+        ("forward", po::value<std::string>(&options.forward_),
+            "forward bulks to a collector at host:port or unix:/path")
+        ("forward-batch", po::value<std::size_t>(&options.forwardBatchBytes_)->default_value(options.forwardBatchBytes_),
+            "bytes of bulks packed into one forwarded batch")
+        ("forward-in-flight", po::value<std::size_t>(&options.forwardInFlight_)->default_value(options.forwardInFlight_)
+            ->notifier([](std::size_t inFlight)
+                {
+                    if (inFlight < 1)
+                    {
+                        throw std::invalid_argument("forward-in-flight must be positive");
+                    }
+                }),
+            "unacknowledged batches kept in flight")
+        ("forward-buffer", po::value<std::size_t>(&options.forwardBufferBytes_)->default_value(options.forwardBufferBytes_),
+            "bytes of batches buffered in memory before spilling to disk")
+        ("forward-spill", po::value<std::string>(&options.forwardSpill_)->default_value(options.forwardSpill_),
+            "spill file for batches while the collector is down")
+        ("wait-spin", po::value<std::size_t>(&options.wait_.spins_)->default_value(options.wait_.spins_),
+            "checks with pause before a waiting thread parks (executor queue and reactors)")
+        ("wait-yield", po::value<std::size_t>(&options.wait_.yields_)->default_value(options.wait_.yields_),
+            "checks with yield before a waiting thread parks")
+        ("busy-poll", po::bool_switch(&options.wait_.busyPoll_),
+            "never park waiting threads, for dedicated cores")
+        ("intern", po::bool_switch(&options.intern_),
+            "share one immutable copy of each repeated command through the pipeline")
+        ("intern-capacity", po::value<std::size_t>(&options.internCapacity_)->default_value(options.internCapacity_),
+            "commands kept in the intern table, least recently used are evicted")
+        ("intern-max-length", po::value<std::size_t>(&options.internMaxLength_)->default_value(options.internMaxLength_),
+            "longest command that is interned");
+    return desc;
+}
+
+/// @brief Получить описание параметров командной строки ограничений разбора
+/// @param limits ограничения памяти разбора одного соединения, заполняемые при разборе командной строки
+/// @return описание параметров
+inline po::options_description parserOptions(BulkReader::Limits& limits)
+{
+    po::options_description desc("Parser limits (0 means unlimited)");
+    desc.add_options()
+        ("max-line", po::value<std::size_t>(&limits.maxLine_)->default_value(limits.maxLine_),
+            "longest command line, bytes")
+        ("max-depth", po::value<std::size_t>(&limits.maxDepth_)->default_value(limits.maxDepth_),
+            "deepest nesting of dynamic blocks")
+        ("max-block", po::value<std::size_t>(&limits.maxBlockBytes_)->default_value(limits.maxBlockBytes_),
+            "largest dynamic block, bytes of memory its commands take")
+        ("on-limit", po::value<std::string>()->default_value("flush")
+            ->notifier([&limits](const std::string& action)
+                {
+                    if (action == "flush")
+                    {
+                        limits.action_ = BulkReader::FLUSH;
+                    }
+                    else if (action == "truncate")
+                    {
+                        limits.action_ = BulkReader::TRUNCATE;
+                    }
+                    else if (action == "close")
+                    {
+                        limits.action_ = BulkReader::CLOSE;
+                    }
+                    else
+                    {
+                        throw std::invalid_argument("on-limit");
+                    }
+                }),
+            "flush (pass a long line in pieces, a large block in parts), truncate (drop the excess) "
+            "or close the connection");
+    return desc;
+}
+
+/// @brief Параметры трассировки
+struct TraceOptions
+{
+    std::string file_;           ///< Файл для выгрузки событий, пустая строка означает выключенную трассировку
+    std::size_t sample_ = 1;     ///< Записывать каждое sample_-е событие потока
+    std::size_t events_ = 65536; ///< Размер кольцевого буфера каждого потока в событиях
+};
+
+/// @brief Получить описание параметров командной строки трассировки
+/// @param options параметры трассировки, заполняемые при разборе командной строки
+/// @return описание параметров
+inline po::options_description traceOptions(TraceOptions& options)
+{
+    po::options_description desc("Trace options");
+    desc.add_options()
+        ("trace", po::value<std::string>(&options.file_),
+            "record pipeline events and dump them to the file in Chrome trace format on exit")
+        ("trace-sample", po::value<std::size_t>(&options.sample_)->default_value(options.sample_),
+            "record every N-th event of a thread")
+        ("trace-events", po::value<std::size_t>(&options.events_)->default_value(options.events_),
+            "per-thread ring buffer size, events");
+    return desc;
+}
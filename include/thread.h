@@ -6,10 +6,21 @@
 #include <chrono>
 #include <functional>
 #include <future>
+#include <string>
 #include <thread>
+#include <vector>
 
 using namespace std::chrono_literals;
 
+/// @brief Набор номеров процессоров
+using CpuSet = std::vector<int>;
+
+/// @brief Разобрать список процессоров
+/// @param list список в формате "0-3,8,10"
+/// @return набор номеров процессоров
+/// @throw std::invalid_argument при ошибке формата
+CpuSet parseCpuList(const std::string& list);
+
 /// @brief Класс потока исполнения
 class Thread
 {
@@ -40,7 +51,11 @@ public:
         {
             throw std::bad_function_call();
         }
-        t_ = std::thread(f_);
+        t_ = std::thread([name = name_, cpus = cpus_, f = f_]
+            {
+                setupCurrent(name, cpus);
+                f();
+            });
     }
 
     /// @brief Запустить поток
@@ -51,6 +66,22 @@ public:
         start();
     }
 
+    /// @brief Задать привязку потока к процессорам
+    /// @param cpus набор процессоров, пустой набор означает отсутствие привязки
+    /// @note Применяется при следующем запуске потока
+    void setAffinity(CpuSet cpus)
+    {
+        cpus_ = std::move(cpus);
+    }
+
+    /// @brief Настроить текущий поток
+    /// @details Задает системное имя потока (не более 15 символов), привязывает поток к процессорам
+    /// и, при наличии libnuma, делает предпочтительным для его выделений памяти узел NUMA первого процессора,
+    /// чтобы очереди и буферы, создаваемые потоком, размещались рядом с ним
+    /// @param name имя потока
+    /// @param cpus набор процессоров, пустой набор означает отсутствие привязки
+    static void setupCurrent(const std::string& name, const CpuSet& cpus);
+
     /// @brief Остановить поток
     void waitStop()
     {
@@ -89,6 +120,7 @@ public:
     }
 protected:
     std::string name_; ///< Имя потока
+    CpuSet cpus_; ///< Процессоры, к которым привязан поток
     std::function<void()> f_; ///< Функция исполнения потока
     std::thread t_; /// Объект потока
 };
@@ -0,0 +1,137 @@
+#pragma once
+
+/// @file
+/// @brief Файл с объявлением записи событий трассировки конвейера обработки команд
+/// @details События записываются в кольцевые буферы потоков и выгружаются в формате Chrome trace (Perfetto).
+/// При сборке без WITH_TRACE все средства трассировки раскрываются в пустые конструкции.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace trace
+{
+
+#ifdef WITH_TRACE
+
+/// @brief Признак наличия трассировки в сборке
+constexpr bool compiled = true;
+
+/// @brief Признак включения трассировки во время исполнения
+extern std::atomic_bool enabled;
+
+/// @brief Получить текущее время трассировки
+/// @return время в наносекундах
+std::uint64_t now();
+
+/// @brief Проверить, нужно ли записывать очередное событие текущего потока с учетом выборки
+/// @return true, если событие нужно записать или false, если нет
+bool sample();
+
+/// @brief Записать завершенное событие в буфер текущего потока
+/// @param name имя события
+/// @param start время начала события
+/// @param arg дополнительный аргумент события (имя типа) или nullptr
+void record(const char* name, std::uint64_t start, const char* arg = nullptr);
+
+/// @brief Метка времени, передаваемая между потоками вместе с данными
+class Stamp
+{
+public:
+    /// @brief Получить метку текущего времени
+    /// @return метка, пустая при выключенной трассировке
+    static Stamp now()
+    {
+        Stamp stamp;
+        if (enabled.load(std::memory_order_relaxed))
+        {
+            stamp.time_ = trace::now();
+        }
+        return stamp;
+    }
+
+    /// @brief Получить время метки
+    /// @return время в наносекундах или 0 для пустой метки
+    std::uint64_t time() const { return time_; }
+
+private:
+    std::uint64_t time_ = 0;
+};
+
+/// @brief Записать событие от метки до текущего момента
+/// @param name имя события
+/// @param stamp метка начала события
+inline void complete(const char* name, Stamp stamp)
+{
+    if (stamp.time() && sample())
+    {
+        record(name, stamp.time());
+    }
+}
+
+/// @brief Класс события, длящегося до конца области видимости
+class Scope
+{
+public:
+    /// @brief Конструктор
+    /// @param name имя события
+    /// @param arg дополнительный аргумент события (имя типа) или nullptr
+    explicit Scope(const char* name, const char* arg = nullptr) : name_(name), arg_(arg)
+    {
+        if (enabled.load(std::memory_order_relaxed) && sample())
+        {
+            start_ = trace::now();
+        }
+    }
+
+    /// @brief Деструктор
+    ~Scope()
+    {
+        if (start_)
+        {
+            record(name_, start_, arg_);
+        }
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* name_;
+    const char* arg_;
+    std::uint64_t start_ = 0;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+/// @brief Записать событие, длящееся до конца области видимости
+#define TRACE_SCOPE(...) ::trace::Scope TRACE_CONCAT(traceScope_, __LINE__)(__VA_ARGS__)
+
+#else
+
+constexpr bool compiled = false;
+
+class Stamp
+{
+public:
+    static Stamp now() { return Stamp(); }
+};
+
+inline void complete(const char*, Stamp) { }
+
+#define TRACE_SCOPE(...) do { } while (false)
+
+#endif
+
+/// @brief Включить запись событий
+/// @param events размер кольцевого буфера каждого потока в событиях
+/// @param sampleEvery записывать каждое sampleEvery-е событие потока
+void enable(std::size_t events, std::size_t sampleEvery);
+
+/// @brief Выгрузить записанные события в формате Chrome trace
+/// @param path путь к файлу
+/// @return true, если события выгружены или false, если нет
+bool dump(const std::string& path);
+
+} //namespace trace
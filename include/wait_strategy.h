@@ -0,0 +1,88 @@
+#pragma once
+
+/// @file
+/// @brief Файл с объявлением стратегии ожидания потоков
+
+#include <cstddef>
+#include <thread>
+
+/// @brief Стратегия ожидания потока
+/// @details Перед засыпанием в ядре поток ограниченное число раз проверяет готовность с инструкцией pause,
+/// затем ограниченное число раз уступает процессор и только после этого засыпает.
+/// По умолчанию поток засыпает сразу, что бережет процессор. Режим активного опроса
+/// предназначен для выделенных ядер: поток не засыпает никогда
+struct WaitStrategy
+{
+    std::size_t spins_ = 0;  ///< Количество проверок с инструкцией pause
+    std::size_t yields_ = 0; ///< Количество проверок с уступкой процессора
+    bool busyPoll_ = false;  ///< Активный опрос без засыпания
+};
+
+/// @brief Подсказать процессору, что поток находится в цикле ожидания
+inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+/// @brief Ожидать готовности без засыпания согласно стратегии
+/// @tparam Ready тип предиката готовности
+/// @param strategy стратегия ожидания
+/// @param ready предикат готовности
+/// @return true, если готовность наступила до засыпания или false, если поток должен заснуть
+template<typename Ready>
+bool spinWait(const WaitStrategy& strategy, Ready&& ready)
+{
+    if (strategy.busyPoll_)
+    {
+        while (!ready())
+        {
+            cpuRelax();
+        }
+        return true;
+    }
+    for (std::size_t i = 0; i < strategy.spins_; ++i)
+    {
+        if (ready())
+        {
+            return true;
+        }
+        cpuRelax();
+    }
+    for (std::size_t i = 0; i < strategy.yields_; ++i)
+    {
+        if (ready())
+        {
+            return true;
+        }
+        std::this_thread::yield();
+    }
+    return ready();
+}
+
+/// @brief Исполнять обработчики asio-контекста согласно стратегии ожидания
+/// @details Между пачками обработчиков контекст опрашивается без блокировки,
+/// а засыпание в ожидании событий происходит только после исчерпания проверок стратегии
+/// @tparam Context тип asio-контекста
+/// @param context asio-контекст
+/// @param strategy стратегия ожидания
+template<typename Context>
+void runWith(Context& context, const WaitStrategy& strategy)
+{
+    if (!strategy.busyPoll_ && !strategy.spins_ && !strategy.yields_)
+    {
+        context.run();
+        return;
+    }
+    while (!context.stopped())
+    {
+        if (spinWait(strategy, [&context]{ return context.poll() || context.stopped(); }))
+        {
+            continue;
+        }
+        context.run_one();
+    }
+}
@@ -3,14 +3,23 @@
 
 #include "async.h"
 #include "cp_queue.h"
+#include "durable_sink.h"
 #include "executor.h"
+#include "fair_queue.h"
+#include "forward_sink.h"
+#include "interner.h"
 #include "logger.h"
 #include "thread.h"
+#include "trace.h"
 #include <algorithm>
+#include <cstring>
+#include <iostream>
 #include <map>
 #include <memory>
 #include <shared_mutex>
 #include <sstream>
+#include <type_traits>
+#include <vector>
 
 namespace async {
 
@@ -26,6 +35,23 @@ struct Context
 
     std::size_t id_ = 0;
     std::atomic_bool isDisconnected_{false};
+    std::atomic<std::size_t> weight_{1};   ///< Вес соединения в справедливом планировщике
+    std::atomic<std::size_t> priority_{0}; ///< Класс приоритета соединения в справедливом планировщике
+};
+
+/// Элемент очереди: контекст, данные, признак последних данных, метка времени постановки в очередь
+template<typename T>
+using BasicItem = std::tuple<std::shared_ptr<Context>, T, bool, trace::Stamp>;
+
+using Item = BasicItem<std::string>;     ///< Элемент с собственной строкой команды
+using InternedItem = BasicItem<Command>; ///< Элемент с командой, разделяемой через таблицу интернирования
+
+/// @brief Очереди исполнителя для одного типа элементов
+template<typename T>
+struct Queues
+{
+    ConsumerProducerQueue<T> fifo_;
+    FairQueue<std::size_t, T> fair_;
 };
 
 class AsyncThread : public Thread
@@ -35,38 +61,96 @@ public:
 
     ~AsyncThread()
     {
-        Thread::stop([]{}, true); // Ожиданиие завершения потока, чтобы сохранить жизнь разделяемых объектов AsyncThread
+        Thread::stop([this]{ disable(); }, true); // Ожиданиие завершения потока, чтобы сохранить жизнь разделяемых объектов AsyncThread
     }
 
     void asyncLoop(std::size_t n)
     {
+        // Набор приемников по умолчанию известен на этапе компиляции и обслуживается без виртуальных вызовов
+        if (!options_.durable_ && options_.forward_.empty())
+        {
+            if (options_.files_)
+            {
+                logging::StaticLogger<logging::CoutSink, logging::FileSink> logger;
+                run(logger, n);
+            }
+            else
+            {
+                logging::StaticLogger<logging::CoutSink> logger;
+                run(logger, n);
+            }
+            return;
+        }
+
         logging::Logger logger;
         logger.addSink(std::make_unique<logging::CoutSink>());
-        logger.addSink(std::make_unique<logging::FileSink>());
-        Executor executor(logger);
+        if (options_.durable_)
+        {
+            logger.addSink(std::make_unique<logging::DurableFileSink>(options_.commitInterval_, options_.commitBytes_,
+                                                                            options_.commitMaxPending_,
+                                                                            options_.sinkCpus_));
+        }
+        else if (options_.files_)
+        {
+            logger.addSink(std::make_unique<logging::FileSink>());
+        }
+        if (!options_.forward_.empty())
+        {
+            logging::ForwardSink::Settings settings;
+            settings.address_ = options_.forward_;
+            settings.batchBytes_ = options_.forwardBatchBytes_;
+            settings.inFlight_ = options_.forwardInFlight_;
+            settings.bufferBytes_ = options_.forwardBufferBytes_;
+            settings.spill_ = options_.forwardSpill_;
+            logger.addSink(std::make_unique<logging::ForwardSink>(settings, options_.sinkCpus_));
+        }
+        run(logger, n);
+    }
 
-        Bulk bulk;
+    template<typename Logger>
+    void run(Logger& logger, std::size_t n)
+    {
+        if (interner_)
+        {
+            run<InternedItem>(logger, n);
+        }
+        else
+        {
+            run<Item>(logger, n);
+        }
+    }
 
-        std::tuple<std::shared_ptr<Context>, std::string, bool> item;
-        while (queue_.waitPop(item))
+    template<typename T, typename Logger>
+    void run(Logger& logger, std::size_t n)
+    {
+        BasicExecutor<Logger> executor(logger);
+
+        BasicBulk<std::tuple_element_t<1, T>> bulk;
+
+        T item;
+        while (pop(item))
         {
+            trace::complete("executor queue wait", std::get<3>(item));
+
             auto ctx = std::get<0>(item);
             auto& data = std::get<1>(item);
+            std::string_view text = data;
             auto isLastData = std::get<2>(item);
 
             std::size_t id = ctx->id_;
 
             // Если строка с разделителями, значит пришел блок с динамическим размером
-            if (std::count(data.begin(), data.end(), '\n'))
+            if (std::count(text.begin(), text.end(), '\n'))
             {
                 std::stringstream is;
-                is << data;
+                is << text;
 
                 std::string cmd;
                 while (std::getline(is, cmd))
                 {
                     bulk.push_back(cmd);
                 }
+                processed_.fetch_add(bulk.size(), std::memory_order_relaxed);
 
                 executor.exec(bulk);
                 bulk.clear();
@@ -74,14 +158,15 @@ public:
             else
             {
                 // пустая команда используется для исполнения накопившихся команд независимо от размера блока
-                if (data.empty())
+                if (text.empty())
                 {
                     executor.exec(bulk);
                     bulk.clear();
                 }
                 else
                 {
-                    bulk.push_back(data);
+                    bulk.push_back(std::move(data));
+                    processed_.fetch_add(1, std::memory_order_relaxed);
                     if (bulk.size() == n)
                     {
                         executor.exec(bulk);
@@ -97,10 +182,133 @@ public:
         }
     }
 
+    /// @brief Получить очереди для типа элементов
+    template<typename T>
+    Queues<T>& queues()
+    {
+        if constexpr (std::is_same_v<T, Item>)
+        {
+            return plain_;
+        }
+        else
+        {
+            return interned_;
+        }
+    }
+
+    /// @brief Поставить элемент в очередь исполнителя
+    template<typename T>
+    void push(T&& item)
+    {
+        if (options_.fair_)
+        {
+            auto& ctx = *std::get<0>(item);
+            auto cost = std::string_view(std::get<1>(item)).size();
+            queues<T>().fair_.push(ctx.id_, std::move(item), cost, ctx.weight_.load(), ctx.priority_.load());
+        }
+        else
+        {
+            queues<T>().fifo_.waitPush(std::move(item));
+        }
+    }
+
+    /// @brief Поставить элементы в очередь исполнителя за одну блокировку
+    template<typename T>
+    void push(std::vector<T>&& items)
+    {
+        if (options_.fair_)
+        {
+            std::vector<typename FairQueue<std::size_t, T>::Entry> entries;
+            entries.reserve(items.size());
+            for (auto& item : items)
+            {
+                auto& ctx = *std::get<0>(item);
+                auto cost = std::string_view(std::get<1>(item)).size();
+                entries.push_back({ctx.id_, std::move(item), cost, ctx.weight_.load(), ctx.priority_.load()});
+            }
+            queues<T>().fair_.push(std::move(entries));
+        }
+        else
+        {
+            queues<T>().fifo_.waitPushRange(std::make_move_iterator(items.begin()), std::make_move_iterator(items.end()));
+        }
+    }
+
+    /// @brief Поставить данные соединения в очередь исполнителя
+    /// @details Без таблицы интернирования элемент хранит собственную строку команды
+    void enqueue(std::shared_ptr<Context> ctx, std::string_view data, bool last)
+    {
+        if (interner_)
+        {
+            push(InternedItem(std::move(ctx), command(data), last, trace::Stamp::now()));
+        }
+        else
+        {
+            push(Item(std::move(ctx), std::string(data), last, trace::Stamp::now()));
+        }
+    }
+
+    /// @brief Поставить данные соединений в очередь исполнителя за одну блокировку
+    /// @param chunks соединения и их данные
+    void enqueue(const std::vector<std::pair<std::shared_ptr<Context>, std::string_view>>& chunks)
+    {
+        auto stamp = trace::Stamp::now();
+        if (interner_)
+        {
+            std::vector<InternedItem> items;
+            items.reserve(chunks.size());
+            for (const auto& [ctx, data] : chunks)
+            {
+                items.emplace_back(ctx, command(data), false, stamp);
+            }
+            push(std::move(items));
+        }
+        else
+        {
+            std::vector<Item> items;
+            items.reserve(chunks.size());
+            for (const auto& [ctx, data] : chunks)
+            {
+                items.emplace_back(ctx, std::string(data), false, stamp);
+            }
+            push(std::move(items));
+        }
+    }
+
+    /// @brief Создать команду, одиночные команды берутся из таблицы интернирования
+    Command command(std::string_view data)
+    {
+        if (!data.empty() && data.find('\n') == std::string_view::npos)
+        {
+            return interner_->intern(data);
+        }
+        return Command(data);
+    }
+
+    /// @brief Получить очередной элемент исполнителя
+    template<typename T>
+    bool pop(T& item)
+    {
+        return options_.fair_ ? queues<T>().fair_.waitPop(item) : queues<T>().fifo_.waitPop(item);
+    }
+
+    /// @brief Заблокировать очереди исполнителя без очищения
+    void disable()
+    {
+        plain_.fifo_.disable();
+        plain_.fair_.disable();
+        interned_.fifo_.disable();
+        interned_.fair_.disable();
+    }
+
+    Options options_;
     // std::map для сортивоки ключей, чтобы легко получить максимальное значение ключей
     std::map<std::size_t, std::shared_ptr<Context>> ctxMap_;
     std::shared_timed_mutex ctxMutex_;
-    ConsumerProducerQueue<std::tuple<std::shared_ptr<Context>, std::string, bool>> queue_;
+    Queues<Item> plain_;
+    Queues<InternedItem> interned_;
+    std::unique_ptr<Interner> interner_;
+    std::atomic<std::size_t> processed_{0}; ///< Количество команд, принятых исполнителем из очереди
 };
 
 AsyncThread asyncThread;
@@ -108,6 +316,21 @@ AsyncThread asyncThread;
 
 } //namespace
 
+void configure(const Options& options)
+{
+    asyncThread.options_ = options;
+    asyncThread.plain_.fair_.setQuantum(options.fairQuantum_);
+    asyncThread.plain_.fifo_.setWaitStrategy(options.wait_);
+    asyncThread.plain_.fair_.setWaitStrategy(options.wait_);
+    asyncThread.interned_.fair_.setQuantum(options.fairQuantum_);
+    asyncThread.interned_.fifo_.setWaitStrategy(options.wait_);
+    asyncThread.interned_.fair_.setWaitStrategy(options.wait_);
+    if (options.intern_)
+    {
+        asyncThread.interner_ = std::make_unique<Interner>(options.internCapacity_, options.internMaxLength_);
+    }
+}
+
 handle_t connect(std::size_t n)
 {
     if (!asyncThread.isStarted())
@@ -115,6 +338,7 @@ handle_t connect(std::size_t n)
         static std::once_flag flag;
         std::call_once(flag, [n]{
                 auto f = [n]{ asyncThread.asyncLoop(n); };
+                asyncThread.setAffinity(asyncThread.options_.executorCpus_);
                 asyncThread.start(f);
             });
     }
@@ -146,7 +370,29 @@ void receive(handle_t handle, const char *data, std::size_t size)
 
     if (!ctx->isDisconnected_)
     {
-        asyncThread.queue_.waitPush(std::make_tuple(ctx, std::string(data, size), false));
+        asyncThread.enqueue(ctx, std::string_view(data, size), false);
+    }
+}
+
+void receive(const Chunk *chunks, std::size_t count)
+{
+    std::vector<std::pair<std::shared_ptr<Context>, std::string_view>> items;
+    items.reserve(count);
+
+    std::shared_lock<std::shared_timed_mutex> lock(asyncThread.ctxMutex_);
+    for (auto chunk = chunks; chunk != chunks + count; ++chunk)
+    {
+        auto it = asyncThread.ctxMap_.find(static_cast<size_t>(chunk->handle_));
+        if (it != asyncThread.ctxMap_.end() && !it->second->isDisconnected_)
+        {
+            items.emplace_back(it->second, std::string_view(chunk->data_, chunk->size_));
+        }
+    }
+    lock.unlock();
+
+    if (!items.empty())
+    {
+        asyncThread.enqueue(items);
     }
 }
 
@@ -164,7 +410,40 @@ void disconnect(handle_t handle)
     lock.unlock();
 
     ctx->isDisconnected_.store(true);
-    asyncThread.queue_.waitPush(std::make_tuple(ctx, std::string(), true));
+    asyncThread.enqueue(std::move(ctx), std::string_view(), true);
+}
+
+void schedule(handle_t handle, std::size_t weight, std::size_t priority)
+{
+    std::size_t id = static_cast<size_t>(handle);
+
+    std::shared_lock<std::shared_timed_mutex> lock(asyncThread.ctxMutex_);
+    auto it = asyncThread.ctxMap_.find(id);
+    if (it == asyncThread.ctxMap_.end())
+    {
+        return;
+    }
+    it->second->weight_.store(weight);
+    it->second->priority_.store(priority);
+}
+
+std::size_t processed()
+{
+    return asyncThread.processed_.load(std::memory_order_relaxed);
+}
+
+void shutdown()
+{
+    // Очередь блокируется без очищения, поэтому поток исполнителя завершится после обработки всех элементов
+    asyncThread.stop([]{ asyncThread.disable(); }, true);
+
+    if (asyncThread.interner_)
+    {
+        auto stats = asyncThread.interner_->stats();
+        std::cerr << "intern: " << stats.entries_ << " entries, " << stats.hits_ << " hits, " << stats.misses_
+                  << " misses, " << stats.evictions_ << " evictions, " << stats.savedBytes_ << " heap bytes not copied"
+                  << std::endl;
+    }
 }
 
 } //namespace async
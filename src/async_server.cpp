@@ -3,18 +3,223 @@
 
 #include "async_server.h"
 #include "async_session.h"
+#include "command_stream.h"
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <mutex>
+#include <type_traits>
+#include <vector>
 
 using namespace async_server;
 
-void Server::do_accept()
+namespace
+{
+
+std::mutex poolsMutex;
+std::vector<std::weak_ptr<BlockPool>> pools; ///< Пулы сессий всех серверов для статистики
+
+void registerPool(const std::shared_ptr<BlockPool>& pool)
+{
+    std::lock_guard<std::mutex> lock(poolsMutex);
+    pools.push_back(pool);
+}
+
+/// @brief Параметр TCP_DEFER_ACCEPT сокета приемника
+/// @details Удовлетворяет требованиям SettableSocketOption boost::asio
+class DeferAccept
+{
+public:
+    /// @brief Конструктор
+    /// @param seconds время ожидания первых данных соединения, с
+    explicit DeferAccept(int seconds) : value_(seconds) { }
+
+    template<typename Protocol>
+    int level(const Protocol&) const
+    {
+        return IPPROTO_TCP;
+    }
+
+    template<typename Protocol>
+    int name(const Protocol&) const
+    {
+        return TCP_DEFER_ACCEPT;
+    }
+
+    template<typename Protocol>
+    const int* data(const Protocol&) const
+    {
+        return &value_;
+    }
+
+    template<typename Protocol>
+    std::size_t size(const Protocol&) const
+    {
+        return sizeof(value_);
+    }
+
+private:
+    int value_;
+};
+
+} //namespace
+
+std::size_t async_server::sessionPoolOverflow()
+{
+    std::size_t heap = 0;
+    std::lock_guard<std::mutex> lock(poolsMutex);
+    for (const auto& weak : pools)
+    {
+        if (auto pool = weak.lock())
+        {
+            heap += pool->heap();
+        }
+    }
+    return heap;
+}
+
+template<typename Protocol>
+template<typename Session>
+std::shared_ptr<Session> BasicServer<Protocol>::makeSession(typename Protocol::socket socket)
+{
+    // Без пула сессии размещаются в куче без общей блокировки пула
+    if (!sessionPool_)
+    {
+        return std::make_shared<Session>(std::move(socket), options_);
+    }
+    return std::allocate_shared<Session>(PoolAllocator<char>(sessionPool_), std::move(socket), options_);
+}
+
+template<typename Protocol>
+BasicServer<Protocol>::BasicServer(ba::io_context& io_context, const typename Protocol::endpoint& endpoint,
+                                   const Options& options) :
+    io_context_(io_context),
+    acceptor_(ba::make_strand(io_context)),
+    options_(options),
+    sessionPool_(options.sessionPool_ ? std::make_shared<BlockPool>(options.sessionPool_) : nullptr)
+{
+    if (sessionPool_)
+    {
+        registerPool(sessionPool_);
+    }
+    acceptor_.open(endpoint.protocol());
+    acceptor_.set_option(ba::socket_base::reuse_address(true));
+    // Буфер приема задается до listen, чтобы масштаб окна TCP был согласован при установлении соединения
+    if (options_.receiveBuffer_)
+    {
+        acceptor_.set_option(ba::socket_base::receive_buffer_size(options_.receiveBuffer_));
+    }
+    if constexpr (std::is_same_v<Protocol, ba::ip::tcp>)
+    {
+        if (options_.noDelay_)
+        {
+            acceptor_.set_option(ba::ip::tcp::no_delay(true));
+        }
+        if (options_.deferAccept_)
+        {
+            acceptor_.set_option(DeferAccept(options_.deferAccept_));
+        }
+    }
+    acceptor_.bind(endpoint);
+    acceptor_.listen(options_.backlog_);
+
+    // Несколько ожидающих операций позволяют реактору принять пачку соединений за одно пробуждение,
+    // их обработчики упорядочены strand-ом приемника, а сессии выполняются в общем контексте
+    for (std::size_t i = 0; i < std::max<std::size_t>(1, options_.accepts_); ++i)
+    {
+        do_accept();
+    }
+}
+
+template<typename Protocol>
+void BasicServer<Protocol>::do_accept()
+{
+    acceptor_.async_accept(ba::any_io_executor(io_context_.get_executor()),
+        [this](boost::system::error_code ec, typename Protocol::socket socket)
+        {
+            if (!ec)
+            {
+                if (options_.slim_)
+                {
+                    makeSession<BasicSlimSession<Protocol>>(std::move(socket))->start();
+                }
+                else
+                {
+                    makeSession<BasicSession<Protocol>>(std::move(socket))->start();
+                }
+            }
+            if (ec != ba::error::operation_aborted)
+            {
+                do_accept();
+            }
+        });
+}
+
+template<typename Protocol>
+std::atomic<std::size_t> BasicDatagramServer<Protocol>::received_{0};
+
+template<typename Protocol>
+BasicDatagramServer<Protocol>::BasicDatagramServer(ba::io_context& io_context, const typename Protocol::endpoint& endpoint,
+                                                   const Options& options) :
+    socket_(io_context, endpoint),
+    options_(options),
+    data_(new char[max_length_]),
+    stream_(n, options.limits_)
+{
+    stream_.schedule(options_.weight_, options_.priority_);
+    do_receive();
+}
+
+template<typename Protocol>
+BasicDatagramServer<Protocol>::~BasicDatagramServer()
+{
+    stream_.close();
+}
+
+template<typename Protocol>
+void BasicDatagramServer<Protocol>::do_receive()
+{
+    socket_.async_receive(ba::buffer(data_.get(), max_length_),
+        [this](boost::system::error_code ec, std::size_t length)
+        {
+            if (!ec && length)
+            {
+                received_++;
+                bool parsed = stream_.feed(data_.get(), length);
+                // Конец датаграммы завершает последнюю команду пакета
+                if (parsed && data_[length - 1] != '\n')
+                {
+                    stream_.feed("\n", 1);
+                }
+                stream_.reset();
+            }
+            if (ec != ba::error::operation_aborted)
+            {
+                do_receive();
+            }
+        });
+}
+
+void StatsServer::do_accept()
 {
     acceptor_.async_accept(
         [this](boost::system::error_code ec, ba::ip::tcp::socket socket)
         {
             if (!ec)
             {
-                std::make_shared<Session>(std::move(socket))->start();
+                auto peer = std::make_shared<ba::ip::tcp::socket>(std::move(socket));
+                auto line = std::make_shared<std::string>("commands " + std::to_string(async::processed())
+                    + " datagrams " + std::to_string(DatagramServer::received() + LocalDatagramServer::received()) + "\n");
+                ba::async_write(*peer, ba::buffer(*line),
+                    [peer, line](boost::system::error_code, std::size_t){ });
+            }
+            if (ec != ba::error::operation_aborted)
+            {
+                do_accept();
             }
-            do_accept();
         });
 }
+
+template class async_server::BasicServer<ba::ip::tcp>;
+template class async_server::BasicServer<ba::local::stream_protocol>;
+template class async_server::BasicDatagramServer<ba::ip::udp>;
+template class async_server::BasicDatagramServer<ba::local::datagram_protocol>;
@@ -2,65 +2,126 @@
 /// @brief Файл с реализацией асинхронной сессии пользователя
 
 #include "async_session.h"
-#include "bulk.h"
+#include "buffer_pool.h"
+#include "trace.h"
+#include <fstream>
 #include <iostream>
 #include <memory>
+#include <string>
 
 using namespace async_server;
 
-void Session::do_read()
+template<typename Protocol>
+std::atomic<std::size_t> BasicSession<Protocol>::count_{0};
+template<typename Protocol>
+std::atomic<std::size_t> BasicSlimSession<Protocol>::count_{0};
+
+namespace
+{
+
+BufferPool& readPool()
+{
+    static BufferPool pool(16 * 1024, 64);
+    return pool;
+}
+
+/// @brief Получить объем резидентной памяти процесса
+/// @return объем памяти в байтах или 0, если он неизвестен
+std::size_t residentBytes()
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+    {
+        if (line.compare(0, 6, "VmRSS:") == 0)
+        {
+            return std::stoul(line.substr(6)) * 1024;
+        }
+    }
+    return 0;
+}
+
+} //namespace
+
+template<typename Protocol>
+void BasicSession<Protocol>::do_read()
 {
     socket_.async_read_some(ba::buffer(data_, max_length_),
-        [this, self = shared_from_this()](boost::system::error_code ec, std::size_t length)
+        [this, self = this->shared_from_this(), stamp = trace::Stamp::now()](boost::system::error_code ec, std::size_t length)
         {
-            if (!ec)
+            trace::complete("async_read_some", stamp);
+            if (!ec && stream_.feed(data_, length))
             {
-                is_ << std::string(data_, length);
-
-                while (reader_.read(bulk_))
-                {
-                    if (state_ == BulkReader::OPENED_BULK)
-                    {
-                        std::string cmds;
-                        for (auto& cmd : bulk_)
-                        {
-                            cmds.append(cmd + '\n');
-                        }
-                        bulk_.clear();
-                        async::receive(handle_, cmds.c_str(), cmds.size());
-                        state_ = BulkReader::CLOSED_BULK;
-                    }
-                    else
-                    {
-                        for (auto& cmd : bulk_)
-                        {
-                            async::receive(handle_, cmd.c_str(), cmd.size());
-                        }
-                        bulk_.clear();
-                    }
-                }
-                is_.clear();
-                if (reader_.state() == BulkReader::CLOSED_BULK)
-                {
-                    for (auto& cmd : bulk_)
-                    {
-                        async::receive(handle_, cmd.c_str(), cmd.size());
-                    }
-                    bulk_.clear();
-                }
-                else
-                {
-                    if (state_ == BulkReader::CLOSED_BULK)
-                    {
-                        async::receive(handle_, "", 0);
-                        state_ = BulkReader::OPENED_BULK;
-                    }
-                }
                 do_read();
             }
             else
             {
-                async::disconnect(handle_);
+                socket_.close(ec);
+                stream_.close();
+            }
+        });
+}
+
+template<typename Protocol>
+void BasicSlimSession<Protocol>::do_wait()
+{
+    socket_.async_wait(socket_type::wait_read,
+        [this, self = this->shared_from_this(), stamp = trace::Stamp::now()](boost::system::error_code ec)
+        {
+            trace::complete("async_wait", stamp);
+            if (ec)
+            {
+                stream_.close();
+                return;
+            }
+
+            auto buffer = readPool().acquire();
+            std::size_t length = socket_.read_some(ba::buffer(buffer.get(), readPool().bufferSize()), ec);
+            bool parsed = true;
+            if (!ec)
+            {
+                parsed = stream_.feed(buffer.get(), length);
             }
+            readPool().release(std::move(buffer));
+
+            if (!parsed || (ec && ec != ba::error::would_block))
+            {
+                socket_.close(ec);
+                stream_.close();
+                return;
+            }
+            stream_.release();
+            do_wait();
         });
 }
+
+template class async_server::BasicSession<ba::ip::tcp>;
+template class async_server::BasicSlimSession<ba::ip::tcp>;
+template class async_server::BasicSession<ba::local::stream_protocol>;
+template class async_server::BasicSlimSession<ba::local::stream_protocol>;
+
+void async_server::printSessionStats(std::ostream& os)
+{
+    std::size_t full = Session::count() + LocalSession::count();
+    std::size_t slim = SlimSession::count() + LocalSlimSession::count();
+    std::size_t sessions = full + slim;
+    std::size_t parsers = CommandStream::parsers();
+    std::size_t buffers = readPool().allocated();
+    std::size_t estimated = full * sizeof(Session) + slim * sizeof(SlimSession)
+                          + parsers * CommandStream::parserSize() + buffers * readPool().bufferSize();
+    std::size_t rss = residentBytes();
+
+    os << "sessions: " << sessions << " (" << slim << " slim), "
+       << "parser states " << parsers << ", pooled buffers " << buffers << ", "
+       << "sizeof(Session) " << sizeof(Session) << ", sizeof(SlimSession) " << sizeof(SlimSession) << ", "
+       << "parser state " << CommandStream::parserSize() << " bytes";
+    auto limits = BulkReader::stats();
+    os << ", session pool overflow " << sessionPoolOverflow();
+    os << ", limits exceeded: line " << limits.line_ << ", depth " << limits.depth_ << ", block " << limits.block_;
+    if (sessions)
+    {
+        os << ", estimated " << estimated / sessions << " bytes/session"
+           << ", rss " << rss / sessions << " bytes/session";
+    }
+    os << std::endl;
+}
@@ -0,0 +1,425 @@
+/// @file
+/// @brief Файл с реализацией генератора нагрузки для сравнения транспортов сервера
+
+#include "thread.h"
+#include <boost/asio.hpp>
+#include <boost/program_options.hpp>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::string_literals;
+
+namespace ba = boost::asio;
+namespace po = boost::program_options;
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+/// @brief Параметры нагрузки
+struct Load
+{
+    std::size_t connections_ = 1; ///< Количество соединений, каждое в своем потоке
+    std::size_t commands_ = 100000; ///< Количество команд на соединение
+    std::size_t batch_ = 1; ///< Количество команд в одной записи или датаграмме
+    std::size_t reconnects_ = 0; ///< Количество повторных одновременных подключений всех соединений
+};
+
+/// @brief Результаты нагрузки
+struct Result
+{
+    std::mutex mutex_;
+    std::vector<Clock::duration> latencies_; ///< Длительности записей
+    std::atomic<std::size_t> bytes_{0}; ///< Количество переданных байт
+    std::vector<Clock::duration> connects_; ///< Длительности подключений
+    std::atomic<std::size_t> failures_{0}; ///< Количество неудавшихся подключений
+    std::atomic<std::size_t> datagrams_{0}; ///< Количество отправленных датаграмм
+};
+
+/// @brief Счетчики сервера
+struct Counters
+{
+    std::size_t commands_ = 0;  ///< Количество команд, принятых исполнителем
+    std::size_t datagrams_ = 0; ///< Количество принятых датаграмм
+};
+
+/// @brief Получить счетчики сервера
+/// @param endpoint адрес сервера счетчиков
+/// @return счетчики сервера
+Counters queryCounters(const ba::ip::tcp::endpoint& endpoint)
+{
+    ba::io_context io_context;
+    ba::ip::tcp::socket socket(io_context);
+    socket.connect(endpoint);
+    ba::streambuf reply;
+    boost::system::error_code ec;
+    ba::read(socket, reply, ec);
+    std::istream is(&reply);
+    Counters counters;
+    std::string commands, datagrams;
+    if (!(is >> commands >> counters.commands_ >> datagrams >> counters.datagrams_))
+    {
+        throw std::runtime_error("unexpected stats reply");
+    }
+    return counters;
+}
+
+/// @brief Класс барьера, одновременно отпускающего все соединения
+/// @details Запоминает моменты отпускания, интервалы между которыми дают длительности волн подключений
+class Barrier
+{
+public:
+    /// @brief Конструктор
+    /// @param count количество ожидающих потоков
+    Barrier(std::size_t count) :
+        count_(count)
+    {
+    }
+
+    /// @brief Дождаться остальных потоков
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto generation = generation_;
+        if (++waiting_ == count_)
+        {
+            waiting_ = 0;
+            generation_++;
+            releases_.push_back(Clock::now());
+            cv_.notify_all();
+        }
+        else
+        {
+            cv_.wait(lock, [&]{ return generation != generation_; });
+        }
+    }
+
+    /// @brief Получить длительности волн между отпусканиями
+    /// @return отсортированные длительности
+    std::vector<Clock::duration> intervals() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<Clock::duration> result;
+        for (std::size_t i = 1; i < releases_.size(); ++i)
+        {
+            result.push_back(releases_[i] - releases_[i - 1]);
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+private:
+    const std::size_t count_;
+    std::size_t waiting_ = 0;
+    std::size_t generation_ = 0;
+    std::vector<Clock::time_point> releases_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+};
+
+/// @brief Сформировать пакеты команд одного соединения
+/// @param id номер соединения
+/// @param load параметры нагрузки
+/// @return пакеты команд
+std::vector<std::string> makeBatches(std::size_t id, const Load& load)
+{
+    std::vector<std::string> batches;
+    std::string batch;
+    for (std::size_t i = 0; i < load.commands_; ++i)
+    {
+        batch += "cmd" + std::to_string(id) + "_" + std::to_string(i) + '\n';
+        if ((i + 1) % load.batch_ == 0 || i + 1 == load.commands_)
+        {
+            batches.push_back(std::move(batch));
+            batch.clear();
+        }
+    }
+    return batches;
+}
+
+/// @brief Отправить команды одного соединения
+/// @details При повторных подключениях соединение переподключается вместе со всеми остальными
+/// и отправляет команды заново в каждой волне
+/// @tparam Protocol протокол сокета
+/// @param endpoint адрес сервера
+/// @param id номер соединения
+/// @param load параметры нагрузки
+/// @param result результаты нагрузки
+/// @param barrier барьер волн подключений
+template<typename Protocol>
+void send(const typename Protocol::endpoint& endpoint, std::size_t id, const Load& load, Result& result, Barrier& barrier)
+{
+    auto batches = makeBatches(id, load);
+    std::vector<Clock::duration> latencies;
+    latencies.reserve(batches.size() * (load.reconnects_ + 1));
+    std::vector<Clock::duration> connects;
+
+    ba::io_context io_context;
+    for (std::size_t round = 0; round <= load.reconnects_; ++round)
+    {
+        if (load.reconnects_)
+        {
+            barrier.wait();
+        }
+        try
+        {
+            typename Protocol::socket socket(io_context);
+            auto connectStart = Clock::now();
+            socket.connect(endpoint);
+            connects.push_back(Clock::now() - connectStart);
+            for (const auto& batch : batches)
+            {
+                auto start = Clock::now();
+                ba::write(socket, ba::buffer(batch));
+                latencies.push_back(Clock::now() - start);
+                result.bytes_ += batch.size();
+            }
+        }
+        catch (const std::exception&)
+        {
+            // Без волн подключений ошибка завершает соединение, в волне она учитывается, чтобы не задержать барьер
+            if (!load.reconnects_)
+            {
+                throw;
+            }
+            result.failures_++;
+        }
+    }
+    if (load.reconnects_)
+    {
+        barrier.wait();
+    }
+
+    std::lock_guard<std::mutex> lock(result.mutex_);
+    result.latencies_.insert(result.latencies_.end(), latencies.begin(), latencies.end());
+    result.connects_.insert(result.connects_.end(), connects.begin(), connects.end());
+}
+
+/// @brief Отправить команды одного соединения датаграммами
+/// @tparam Protocol протокол датаграммного сокета
+/// @param endpoint адрес сервера
+/// @param id номер соединения
+/// @param load параметры нагрузки
+/// @param result результаты нагрузки
+template<typename Protocol>
+void sendDatagrams(const typename Protocol::endpoint& endpoint, std::size_t id, const Load& load, Result& result)
+{
+    auto batches = makeBatches(id, load);
+    std::vector<Clock::duration> latencies;
+    latencies.reserve(batches.size());
+
+    ba::io_context io_context;
+    typename Protocol::socket socket(io_context);
+    socket.open(endpoint.protocol());
+    socket.connect(endpoint);
+    for (const auto& batch : batches)
+    {
+        auto start = Clock::now();
+        socket.send(ba::buffer(batch));
+        latencies.push_back(Clock::now() - start);
+        result.bytes_ += batch.size();
+        result.datagrams_++;
+    }
+
+    std::lock_guard<std::mutex> lock(result.mutex_);
+    result.latencies_.insert(result.latencies_.end(), latencies.begin(), latencies.end());
+}
+
+/// @brief Получить перцентиль длительностей
+/// @param latencies отсортированные длительности
+/// @param p перцентиль от 0 до 1
+/// @return длительность в микросекундах
+double percentile(const std::vector<Clock::duration>& latencies, double p)
+{
+    if (latencies.empty())
+    {
+        return 0;
+    }
+    auto i = std::min(latencies.size() - 1, static_cast<std::size_t>(p * latencies.size()));
+    return std::chrono::duration<double, std::micro>(latencies[i]).count();
+}
+
+} //namespace
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        Load load;
+        std::string transport = "tcp";
+        std::string host = "127.0.0.1";
+        std::uint16_t port = 9000;
+        std::string path;
+        std::uint16_t statsPort = 0;
+        std::size_t drainTimeout = 1000;
+
+        po::options_description desc("Options");
+        desc.add_options()
+            ("transport", po::value<std::string>(&transport)->default_value(transport), "tcp, unix, udp or unix-dgram")
+            ("host", po::value<std::string>(&host)->default_value(host), "server address for tcp and udp")
+            ("port", po::value<std::uint16_t>(&port)->default_value(port), "server port for tcp and udp")
+            ("path", po::value<std::string>(&path), "server socket path for unix and unix-dgram")
+            ("connections", po::value<std::size_t>(&load.connections_)->default_value(load.connections_),
+                "number of concurrent connections")
+            ("commands", po::value<std::size_t>(&load.commands_)->default_value(load.commands_),
+                "number of commands per connection")
+            ("batch", po::value<std::size_t>(&load.batch_)->default_value(load.batch_),
+                "number of commands per write or datagram")
+            ("stats-port", po::value<std::uint16_t>(&statsPort),
+                "server --stats-port: wait until the server has processed the commands and report end-to-end results")
+            ("drain-timeout", po::value<std::size_t>(&drainTimeout)->default_value(drainTimeout),
+                "ms without progress of the server counters before the rest is counted as lost")
+            ("reconnects", po::value<std::size_t>(&load.reconnects_)->default_value(load.reconnects_),
+                "reconnect storms: all connections connect together, send, close and repeat, tcp and unix only")
+            ("help,h", "print usage");
+
+        auto usage = "Usage: "s + argv[0] + " [options]";
+        po::variables_map vm;
+        try
+        {
+            po::store(po::parse_command_line(argc, argv, desc), vm);
+            po::notify(vm);
+            if (load.connections_ < 1 || load.batch_ < 1)
+            {
+                throw std::invalid_argument("connections and batch must be positive");
+            }
+            if ((transport == "unix" || transport == "unix-dgram") && path.empty())
+            {
+                throw std::invalid_argument("path is required for " + transport);
+            }
+            if (load.reconnects_ && transport != "tcp" && transport != "unix")
+            {
+                throw std::invalid_argument("reconnects need a stream transport");
+            }
+        }
+        catch (std::exception& e)
+        {
+            std::cerr << "Invalid argument: " << e.what() << '\n' << usage << '\n' << desc << std::endl;
+            return 1;
+        }
+        if (vm.count("help"))
+        {
+            std::cout << usage << '\n' << desc << std::endl;
+            return 0;
+        }
+
+        Barrier barrier(load.connections_);
+        std::function<void(std::size_t, Result&)> connection;
+        auto address = ba::ip::make_address(host);
+        if (transport == "tcp")
+        {
+            connection = [&](std::size_t id, Result& result){ send<ba::ip::tcp>({address, port}, id, load, result, barrier); };
+        }
+        else if (transport == "unix")
+        {
+            connection = [&](std::size_t id, Result& result){ send<ba::local::stream_protocol>(path, id, load, result, barrier); };
+        }
+        else if (transport == "udp")
+        {
+            connection = [&](std::size_t id, Result& result){ sendDatagrams<ba::ip::udp>({address, port}, id, load, result); };
+        }
+        else if (transport == "unix-dgram")
+        {
+            connection = [&](std::size_t id, Result& result){ sendDatagrams<ba::local::datagram_protocol>(path, id, load, result); };
+        }
+        else
+        {
+            std::cerr << "Invalid argument: transport " << transport << '\n' << usage << std::endl;
+            return 1;
+        }
+
+        ba::ip::tcp::endpoint statsEndpoint(address, statsPort);
+        Counters before;
+        if (statsPort)
+        {
+            before = queryCounters(statsEndpoint);
+        }
+
+        Result result;
+        auto start = Clock::now();
+        {
+            std::vector<std::unique_ptr<Thread>> threads;
+            for (std::size_t i = 0; i < load.connections_; ++i)
+            {
+                threads.push_back(std::make_unique<Thread>("bench" + std::to_string(i), [&, i]
+                    {
+                        try
+                        {
+                            connection(i, result);
+                        }
+                        catch (const std::exception& ex)
+                        {
+                            std::cerr << "connection " << i << ": " << ex.what() << std::endl;
+                        }
+                    }));
+                threads.back()->start();
+            }
+        }
+        auto sent = Clock::now();
+        std::chrono::duration<double> elapsed = sent - start;
+
+        auto& latencies = result.latencies_;
+        std::sort(latencies.begin(), latencies.end());
+        auto commands = load.connections_ * load.commands_ * (load.reconnects_ + 1);
+        std::cout << transport << ": " << load.connections_ << " connection(s), " << commands << " commands, batch "
+                  << load.batch_ << ", " << elapsed.count() << " s, " << commands / elapsed.count() << " commands/s, "
+                  << result.bytes_ / elapsed.count() / (1024 * 1024) << " MiB/s, write latency us p50 "
+                  << percentile(latencies, 0.5) << " p99 " << percentile(latencies, 0.99) << " max "
+                  << percentile(latencies, 1.0) << std::endl;
+        if (statsPort)
+        {
+            // Счетчики опрашиваются, пока сервер не примет все команды или не перестанет продвигаться
+            Counters after = queryCounters(statsEndpoint);
+            auto progress = Clock::now();
+            while (after.commands_ - before.commands_ < commands
+                   && Clock::now() - progress < std::chrono::milliseconds(drainTimeout))
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                auto current = queryCounters(statsEndpoint);
+                if (current.commands_ != after.commands_)
+                {
+                    progress = Clock::now();
+                }
+                after = current;
+            }
+            std::chrono::duration<double> endToEnd = progress - start;
+            auto processed = after.commands_ - before.commands_;
+            std::cout << "end-to-end: " << processed << " of " << commands << " commands processed, "
+                      << endToEnd.count() << " s, " << processed / endToEnd.count() << " commands/s, drain "
+                      << std::chrono::duration<double, std::milli>(std::max(progress, sent) - sent).count() << " ms";
+            if (result.datagrams_)
+            {
+                auto received = after.datagrams_ - before.datagrams_;
+                std::cout << ", datagrams " << received << " of " << result.datagrams_ << " received ("
+                          << 100.0 * (result.datagrams_ - std::min<std::size_t>(received, result.datagrams_)) / result.datagrams_
+                          << "% lost)";
+            }
+            std::cout << std::endl;
+        }
+        if (load.reconnects_)
+        {
+            auto storms = barrier.intervals();
+            auto& connects = result.connects_;
+            std::sort(connects.begin(), connects.end());
+            std::cout << "reconnect storms: " << storms.size() << " x " << load.connections_ << " connections, storm ms p50 "
+                      << percentile(storms, 0.5) / 1000 << " max " << percentile(storms, 1.0) / 1000
+                      << ", connect us p50 " << percentile(connects, 0.5) << " p99 " << percentile(connects, 0.99)
+                      << " max " << percentile(connects, 1.0) << ", failed " << result.failures_ << std::endl;
+        }
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "Exception: " << ex.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -3,60 +3,157 @@
 
 #include "bulk_reader.h"
 #include "bulk.h"
+#include "trace.h"
 #include <algorithm>
 #include <iostream>
 #include <string>
 
+std::atomic<std::size_t> BulkReader::lineExceeded_{0};
+std::atomic<std::size_t> BulkReader::depthExceeded_{0};
+std::atomic<std::size_t> BulkReader::blockExceeded_{0};
+
 bool BulkReader::read(Bulk& bulk)
 {
-    while (bulk.size() < n_ || state() == OPENED_BULK)
+    TRACE_SCOPE("BulkReader::read");
+    while (!failed_ && (bulk.size() < n_ || state() == OPENED_BULK))
     {
         char ch = 0;
         std::string cmd;
+        bool continuation = continuation_;
+        bool split = false;
         while (is_.get(ch) && ch != '\n')
         {
+            if (skipLine_)
+            {
+                continue;
+            }
+            if (limits_.maxLine_ && buffer_.size() >= limits_.maxLine_)
+            {
+                if (!exceeded(lineExceeded_))
+                {
+                    return false;
+                }
+                if (limits_.action_ == TRUNCATE)
+                {
+                    skipLine_ = true;
+                    continue;
+                }
+                // Накопленная часть строки передается как отдельная команда, остаток начинает следующую часть
+                is_.unget();
+                split = true;
+                break;
+            }
             buffer_.push_back(ch);
         }
         if (is_.eof())
         {
             return false;
         }
+        skipLine_ = false;
+        continuation_ = split;
 
         cmd.swap(buffer_);
 
-        ltrim(cmd);
-        if (cmd.empty())
+        // Продолжение длинной строки всегда является командой: без удаления пробелов и без скобок блока
+        if (!continuation)
         {
-            continue;
-        }
-        if (cmd[0] == '{')
-        {
-            openDepth_++;
-            if (openDepth_ == 1)
+            ltrim(cmd);
+            if (cmd.empty())
             {
-                return true;
+                continuation_ = false;
+                continue;
             }
+            if (cmd[0] == '{' || cmd[0] == '}')
+            {
+                // Остаток длинной строки со скобкой отбрасывается, как и без ограничения длины
+                skipLine_ = split;
+                continuation_ = false;
+                if (brace(cmd[0]))
+                {
+                    return true;
+                }
+                if (failed_)
+                {
+                    return false;
+                }
+                continue;
+            }
+        }
+
+        std::size_t bytes = footprint(cmd);
+        if (truncatingBlock_)
+        {
+            // Остаток блока, превысившего ограничение, отбрасывается до его закрытия
             continue;
         }
-        else if (cmd[0] == '}')
+        if (openDepth_ && limits_.maxBlockBytes_ && blockBytes_ + bytes > limits_.maxBlockBytes_)
         {
-            if (openDepth_ == 0) // случай, если изменение размера блока начинается с символа '}'
+            if (!exceeded(blockExceeded_))
             {
-                continue;
+                return false;
             }
-            openDepth_--;
-            if (openDepth_ == 0)
+            if (limits_.action_ == FLUSH)
             {
+                // Накопленная часть блока передается, блок остается открытым
+                bulk.push_back(std::move(cmd));
+                blockBytes_ = 0;
                 return true;
             }
+            truncatingBlock_ = true;
             continue;
         }
-        else
+        blockBytes_ += bytes;
+        bulk.push_back(std::move(cmd));
+    }
+    return !failed_;
+}
+
+bool BulkReader::brace(char ch)
+{
+    if (ch == '{')
+    {
+        if (limits_.maxDepth_ && openDepth_ >= limits_.maxDepth_)
         {
-            bulk.push_back(std::move(cmd));
+            if (exceeded(depthExceeded_))
+            {
+                // Лишняя вложенность игнорируется вместе с парной закрывающей скобкой
+                ignoredDepth_++;
+            }
+            return false;
         }
+        openDepth_++;
+        if (openDepth_ == 1)
+        {
+            blockBytes_ = 0;
+            truncatingBlock_ = false;
+            return true;
+        }
+        return false;
+    }
+    if (ignoredDepth_)
+    {
+        ignoredDepth_--;
+        return false;
+    }
+    if (openDepth_ == 0) // случай, если изменение размера блока начинается с символа '}'
+    {
+        return false;
+    }
+    openDepth_--;
+    if (openDepth_ == 0)
+    {
+        truncatingBlock_ = false;
+        return true;
     }
-    return true;
+    return false;
+}
+
+std::size_t BulkReader::footprint(const std::string& cmd)
+{
+    // Короткая строка хранится внутри объекта std::string и не занимает памяти в куче
+    bool heap = cmd.capacity() > std::string().capacity();
+    // Вектор блока при росте удваивается, поэтому на команду приходится до двух его элементов
+    return 2 * sizeof(std::string) + (heap ? cmd.capacity() + 1 : 0);
 }
 
 BulkReader::State BulkReader::state() const
@@ -64,6 +161,23 @@ BulkReader::State BulkReader::state() const
     return openDepth_? OPENED_BULK : CLOSED_BULK;
 }
 
+BulkReader::Stats BulkReader::stats()
+{
+    return {lineExceeded_.load(), depthExceeded_.load(), blockExceeded_.load()};
+}
+
+bool BulkReader::exceeded(std::atomic<std::size_t>& counter)
+{
+    counter++;
+    if (limits_.action_ == CLOSE)
+    {
+        failed_ = true;
+        buffer_.clear();
+        buffer_.shrink_to_fit();
+    }
+    return !failed_;
+}
+
 void BulkReader::ltrim(std::string& str) const
 {
     auto it = std::find_if(str.begin() ,str.end(), [](char ch){ return !std::isspace(ch); } );
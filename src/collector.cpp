@@ -0,0 +1,217 @@
+/// @file
+/// @brief Файл с реализацией локального сборщика блоков для тестов и замеров пересылки
+
+#include <boost/asio.hpp>
+#include <boost/program_options.hpp>
+#include <arpa/inet.h>
+#include <endian.h>
+#include <unistd.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace std::string_literals;
+
+namespace ba = boost::asio;
+namespace po = boost::program_options;
+
+namespace
+{
+
+/// @brief Статистика сборщика
+struct Stats
+{
+    std::size_t frames_ = 0; ///< Количество принятых кадров
+    std::size_t bytes_ = 0;  ///< Количество принятых байт блоков
+    std::size_t bulks_ = 0;  ///< Количество принятых блоков
+};
+
+/// @brief Класс соединения с приемником пересылки
+/// @tparam Protocol протокол потокового сокета
+template<typename Protocol>
+class Connection : public std::enable_shared_from_this<Connection<Protocol>>
+{
+public:
+    Connection(typename Protocol::socket socket, std::ostream* os, Stats& stats) :
+        socket_(std::move(socket)),
+        os_(os),
+        stats_(stats)
+    {
+    }
+
+    void start()
+    {
+        readHeader();
+    }
+
+private:
+    void readHeader()
+    {
+        ba::async_read(socket_, ba::buffer(&size_, sizeof(size_)),
+            [this, self = this->shared_from_this()](const boost::system::error_code& ec, std::size_t)
+            {
+                if (!ec)
+                {
+                    payload_.resize(ntohl(size_));
+                    readPayload();
+                }
+            });
+    }
+
+    void readPayload()
+    {
+        ba::async_read(socket_, ba::buffer(payload_),
+            [this, self = this->shared_from_this()](const boost::system::error_code& ec, std::size_t)
+            {
+                if (ec)
+                {
+                    return;
+                }
+                if (os_)
+                {
+                    os_->write(payload_.data(), static_cast<std::streamsize>(payload_.size()));
+                }
+                stats_.frames_++;
+                stats_.bytes_ += payload_.size();
+                stats_.bulks_ += static_cast<std::size_t>(std::count(payload_.begin(), payload_.end(), '\n'));
+                frames_++;
+                writeAck();
+                readHeader();
+            });
+    }
+
+    void writeAck()
+    {
+        // Подтверждение накопительное, поэтому кадры, принятые во время записи, подтверждаются следующей записью
+        if (writing_ || acked_ == frames_)
+        {
+            return;
+        }
+        writing_ = true;
+        acked_ = frames_;
+        ack_ = htobe64(acked_);
+        ba::async_write(socket_, ba::buffer(&ack_, sizeof(ack_)),
+            [this, self = this->shared_from_this()](const boost::system::error_code& ec, std::size_t)
+            {
+                writing_ = false;
+                if (!ec)
+                {
+                    writeAck();
+                }
+            });
+    }
+
+    typename Protocol::socket socket_;
+    std::ostream* os_;
+    Stats& stats_;
+    std::uint32_t size_ = 0;
+    std::string payload_;
+    std::uint64_t frames_ = 0;
+    std::uint64_t acked_ = 0;
+    std::uint64_t ack_ = 0;
+    bool writing_ = false;
+};
+
+/// @brief Принимать соединения
+/// @tparam Protocol протокол потокового сокета
+template<typename Protocol>
+void accept(typename Protocol::acceptor& acceptor, std::ostream* os, Stats& stats)
+{
+    acceptor.async_accept([&acceptor, os, &stats](const boost::system::error_code& ec, typename Protocol::socket socket)
+        {
+            if (!ec)
+            {
+                std::make_shared<Connection<Protocol>>(std::move(socket), os, stats)->start();
+            }
+            accept<Protocol>(acceptor, os, stats);
+        });
+}
+
+} //namespace
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        std::uint16_t port = 0;
+        std::string path;
+        std::string output;
+        bool quiet = false;
+
+        po::options_description desc("Options");
+        desc.add_options()
+            ("port", po::value<std::uint16_t>(&port), "listen on the TCP port")
+            ("unix", po::value<std::string>(&path), "listen on the Unix domain socket path")
+            ("output", po::value<std::string>(&output), "append received bulks to the file instead of stdout")
+            ("quiet", po::bool_switch(&quiet), "discard received bulks, only count them")
+            ("help,h", "print usage");
+
+        auto usage = "Usage: "s + argv[0] + " [options]";
+        po::variables_map vm;
+        try
+        {
+            po::store(po::parse_command_line(argc, argv, desc), vm);
+            po::notify(vm);
+            if (!port && path.empty() && !vm.count("help"))
+            {
+                throw std::invalid_argument("port or unix path is required");
+            }
+        }
+        catch (std::exception& e)
+        {
+            std::cerr << "Invalid argument: " << e.what() << '\n' << usage << '\n' << desc << std::endl;
+            return 1;
+        }
+        if (vm.count("help"))
+        {
+            std::cout << usage << '\n' << desc << std::endl;
+            return 0;
+        }
+
+        std::ofstream file;
+        std::ostream* os = quiet ? nullptr : &std::cout;
+        if (!output.empty() && !quiet)
+        {
+            file.open(output, std::ios::binary | std::ios::app);
+            os = &file;
+        }
+
+        Stats stats;
+        ba::io_context io_context;
+        std::unique_ptr<ba::ip::tcp::acceptor> tcp;
+        if (port)
+        {
+            tcp = std::make_unique<ba::ip::tcp::acceptor>(io_context, ba::ip::tcp::endpoint(ba::ip::tcp::v4(), port));
+            accept<ba::ip::tcp>(*tcp, os, stats);
+        }
+        std::unique_ptr<ba::local::stream_protocol::acceptor> local;
+        if (!path.empty())
+        {
+            ::unlink(path.c_str());
+            local = std::make_unique<ba::local::stream_protocol::acceptor>(io_context, ba::local::stream_protocol::endpoint(path));
+            accept<ba::local::stream_protocol>(*local, os, stats);
+        }
+
+        ba::signal_set signals(io_context, SIGINT, SIGTERM);
+        signals.async_wait([&io_context](boost::system::error_code, int){ io_context.stop(); });
+
+        auto start = std::chrono::steady_clock::now();
+        io_context.run();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        if (!path.empty())
+        {
+            ::unlink(path.c_str());
+        }
+        std::cerr << "collector: " << stats.frames_ << " frames, " << stats.bulks_ << " bulks, " << stats.bytes_
+                  << " bytes in " << elapsed.count() << " s" << std::endl;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "Exception: " << ex.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
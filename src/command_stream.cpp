@@ -0,0 +1,105 @@
+/// @file
+/// @brief Файл с реализацией потока команд одного соединения
+
+#include "command_stream.h"
+#include <string>
+#include <vector>
+
+std::atomic<std::size_t> CommandStream::parsers_{0};
+
+bool CommandStream::feed(const char* data, std::size_t size)
+{
+    if (!parser_)
+    {
+        parser_ = std::make_unique<Parser>(n_, limits_);
+    }
+    auto& bulk = parser_->bulk_;
+    auto& reader = parser_->reader_;
+    auto& is = parser_->is_;
+
+    // Команды и блоки порции собираются и передаются исполнителю одним пакетом
+    std::vector<std::string> out;
+
+    is << std::string(data, size);
+
+    while (reader.read(bulk))
+    {
+        if (state_ == BulkReader::OPENED_BULK)
+        {
+            std::string cmds;
+            for (auto& cmd : bulk)
+            {
+                cmds.append(cmd + '\n');
+            }
+            bulk.clear();
+            out.push_back(std::move(cmds));
+            state_ = BulkReader::CLOSED_BULK;
+        }
+        else
+        {
+            for (auto& cmd : bulk)
+            {
+                out.push_back(std::move(cmd));
+            }
+            bulk.clear();
+        }
+        // Открытие динамического блока или передача его части отмечается пустой командой
+        if (reader.state() == BulkReader::OPENED_BULK && state_ == BulkReader::CLOSED_BULK)
+        {
+            out.emplace_back();
+            state_ = BulkReader::OPENED_BULK;
+        }
+    }
+    bool failed = reader.failed();
+    // Порция разобрана целиком, незавершенная строка хранится в читателе
+    is.str(std::string());
+    is.clear();
+    if (failed)
+    {
+        // Незавершенный блок соединения, превысившего ограничение, отбрасывается
+        parser_.reset();
+        state_ = BulkReader::CLOSED_BULK;
+    }
+    else if (reader.state() == BulkReader::CLOSED_BULK)
+    {
+        for (auto& cmd : bulk)
+        {
+            out.push_back(std::move(cmd));
+        }
+        bulk.clear();
+    }
+    else
+    {
+        if (state_ == BulkReader::CLOSED_BULK)
+        {
+            out.emplace_back();
+            state_ = BulkReader::OPENED_BULK;
+        }
+    }
+
+    if (!out.empty())
+    {
+        std::vector<async::Chunk> chunks;
+        chunks.reserve(out.size());
+        for (const auto& s : out)
+        {
+            chunks.push_back({handle_, s.data(), s.size()});
+        }
+        async::receive(chunks.data(), chunks.size());
+    }
+    return !failed;
+}
+
+bool CommandStream::release()
+{
+    if (parser_ && parser_->reader_.empty() && parser_->bulk_.empty() && state_ == BulkReader::CLOSED_BULK)
+    {
+        parser_.reset();
+    }
+    return !parser_;
+}
+
+void CommandStream::close()
+{
+    async::disconnect(handle_);
+}
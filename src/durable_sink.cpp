@@ -0,0 +1,224 @@
+/// @file
+/// @brief Файл с реализацией приемника данных в файл с групповой фиксацией на диск
+
+#include "durable_sink.h"
+#include "trace.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <set>
+
+using namespace logging;
+
+DurableFileSink::DurableFileSink(std::chrono::milliseconds interval, std::size_t bytes, std::size_t maxPending,
+                                 CpuSet cpus) :
+    interval_(interval),
+    bytes_(bytes),
+    maxPending_(maxPending),
+    thread_("durableSink")
+{
+    thread_.setAffinity(std::move(cpus));
+    thread_.start([this]{ commitLoop(); });
+}
+
+DurableFileSink::~DurableFileSink()
+{
+    thread_.stop([this]
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopped_ = true;
+            cond_.notify_one();
+            space_.notify_all();
+        }, true);
+
+    for (auto& file : files_)
+    {
+        ::close(file.second);
+    }
+
+    auto s = stats();
+    std::cerr << "durable: " << s.commits_ << " commits, " << s.bulks_ << " bulks, " << s.bytes_ << " bytes, "
+              << "avg latency " << (s.commits_ ? s.totalLatency_.count() / s.commits_ : 0) << " us, "
+              << "max latency " << s.maxLatency_.count() << " us, " << s.stalls_ << " writer stalls, "
+              << s.failedBulks_ << " bulks (" << s.failedBytes_ << " bytes) failed" << std::endl;
+}
+
+void DurableFileSink::write(const Message& msg)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (maxPending_ && pendingBytes_ >= maxPending_)
+    {
+        stats_.stalls_++;
+        cond_.notify_one();
+        space_.wait(lock, [this]{ return pendingBytes_ < maxPending_ || stopped_; });
+    }
+    if (pending_.empty())
+    {
+        first_ = Clock::now();
+    }
+    pending_.push_back(msg);
+    pendingBytes_ += msg.text_.size() + 1;
+    if (pendingBytes_ >= bytes_)
+    {
+        cond_.notify_one();
+    }
+}
+
+DurableFileSink::Stats DurableFileSink::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void DurableFileSink::commitLoop()
+{
+    std::vector<Message> batch;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        cond_.wait_for(lock, interval_, [this]{ return stopped_ || (!pending_.empty() && pendingBytes_ >= bytes_); });
+        if (pending_.empty())
+        {
+            if (stopped_)
+            {
+                break;
+            }
+            continue;
+        }
+        batch.swap(pending_);
+        pendingBytes_ = 0;
+        auto first = first_;
+        lock.unlock();
+        space_.notify_all();
+
+        commit(batch, first);
+        batch.clear();
+
+        lock.lock();
+    }
+}
+
+void DurableFileSink::commit(const std::vector<Message>& batch, Clock::time_point first)
+{
+    TRACE_SCOPE("DurableFileSink::commit");
+    // Блоки группируются по файлам, чтобы каждый файл записывался и фиксировался один раз
+    struct Group
+    {
+        std::string text_;
+        std::size_t bulks_ = 0;
+    };
+    std::map<std::time_t, Group> groups;
+    for (const auto& msg : batch)
+    {
+        auto& group = groups[std::chrono::system_clock::to_time_t(msg.tp_)];
+        group.text_.append(msg.text_).push_back('\n');
+        group.bulks_++;
+    }
+
+    // Зафиксированными считаются только данные, для которых успешно выполнены запись и fdatasync
+    Stats result;
+    std::set<std::time_t> touched;
+    for (const auto& [t, group] : groups)
+    {
+        bool ok = false;
+        int fd = file(t);
+        if (fd >= 0)
+        {
+            touched.insert(t);
+            ok = true;
+            const char* data = group.text_.data();
+            std::size_t left = group.text_.size();
+            while (left)
+            {
+                auto written = ::write(fd, data, left);
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    std::cerr << "durable: write failed: " << std::strerror(errno) << std::endl;
+                    ok = false;
+                    break;
+                }
+                data += written;
+                left -= static_cast<std::size_t>(written);
+            }
+            if (::fdatasync(fd) != 0)
+            {
+                std::cerr << "durable: fdatasync failed: " << std::strerror(errno) << std::endl;
+                ok = false;
+            }
+        }
+        (ok ? result.bulks_ : result.failedBulks_) += group.bulks_;
+        (ok ? result.bytes_ : result.failedBytes_) += group.text_.size();
+    }
+
+    // Файлы, не затронутые текущей фиксацией, больше не нужны: имена файлов определяются временем блока
+    for (auto it = files_.begin(); it != files_.end();)
+    {
+        if (touched.count(it->first))
+        {
+            ++it;
+        }
+        else
+        {
+            ::close(it->second);
+            it = files_.erase(it);
+        }
+    }
+
+    auto latency = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - first);
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.commits_++;
+    stats_.bulks_ += result.bulks_;
+    stats_.bytes_ += result.bytes_;
+    stats_.failedBulks_ += result.failedBulks_;
+    stats_.failedBytes_ += result.failedBytes_;
+    stats_.totalLatency_ += latency;
+    stats_.maxLatency_ = std::max(stats_.maxLatency_, latency);
+}
+
+int DurableFileSink::file(std::time_t t)
+{
+    auto it = files_.find(t);
+    if (it != files_.end())
+    {
+        return it->second;
+    }
+    auto fileName = "bulk" + std::to_string(t) + ".log";
+    int fd = ::open(fileName.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        std::cerr << "durable: cannot open " << fileName << ": " << std::strerror(errno) << std::endl;
+        return fd;
+    }
+    // fdatasync не фиксирует запись о файле в каталоге: без этого файл целиком может пропасть после сбоя.
+    // Каталог фиксируется при каждом открытии, в том числе если файл был создан при неудачной попытке
+    if (!syncDirectory())
+    {
+        ::close(fd);
+        return -1;
+    }
+    files_.emplace(t, fd);
+    return fd;
+}
+
+bool DurableFileSink::syncDirectory()
+{
+    int dir = ::open(".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir < 0)
+    {
+        std::cerr << "durable: cannot open directory: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    bool ok = ::fsync(dir) == 0;
+    if (!ok)
+    {
+        std::cerr << "durable: directory fsync failed: " << std::strerror(errno) << std::endl;
+    }
+    ::close(dir);
+    return ok;
+}
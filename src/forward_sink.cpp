@@ -0,0 +1,475 @@
+/// @file
+/// @brief Файл с реализацией приемника данных, пересылающего блоки сборщику
+
+#include "forward_sink.h"
+#include "trace.h"
+#include <arpa/inet.h>
+#include <endian.h>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+
+using namespace logging;
+
+namespace
+{
+
+constexpr std::chrono::milliseconds minBackoff{100};
+constexpr std::chrono::milliseconds maxBackoff{5000};
+constexpr std::chrono::milliseconds grace{1000}; ///< Время на доставку ожидающих пакетов при завершении
+
+ba::generic::stream_protocol::endpoint resolve(const std::string& address)
+{
+    const std::string unixPrefix = "unix:";
+    if (address.compare(0, unixPrefix.size(), unixPrefix) == 0)
+    {
+        return ba::local::stream_protocol::endpoint(address.substr(unixPrefix.size()));
+    }
+
+    auto colon = address.rfind(':');
+    if (colon == std::string::npos || colon == 0)
+    {
+        throw std::invalid_argument("forward address: " + address);
+    }
+    ba::io_context io_context;
+    ba::ip::tcp::resolver resolver(io_context);
+    auto results = resolver.resolve(address.substr(0, colon), address.substr(colon + 1));
+    if (results.empty())
+    {
+        throw std::invalid_argument("forward address: " + address);
+    }
+    return results.begin()->endpoint();
+}
+
+} //namespace
+
+ForwardSink::ForwardSink(const Settings& settings, CpuSet cpus) :
+    settings_(settings),
+    endpoint_(resolve(settings.address_)),
+    work_(ba::make_work_guard(io_)),
+    socket_(io_),
+    timer_(io_),
+    reconnectTimer_(io_),
+    graceTimer_(io_),
+    backoff_(minBackoff),
+    thread_("forwardSink")
+{
+    // Пакеты, не доставленные в прошлый запуск, отправляются первыми
+    std::ifstream previous(settings_.spill_, std::ios::binary | std::ios::ate);
+    if (previous && previous.tellg() > 0)
+    {
+        spillSize_ = static_cast<std::uint64_t>(previous.tellg());
+    }
+
+    ba::post(io_, [this]
+        {
+            connect();
+            tick();
+        });
+    thread_.setAffinity(std::move(cpus));
+    thread_.start([this]{ io_.run(); });
+}
+
+ForwardSink::~ForwardSink()
+{
+    ba::post(io_, [this]
+        {
+            closing_ = true;
+            timer_.cancel();
+            flushCurrent();
+            if (!connected_)
+            {
+                spillAll();
+            }
+            graceTimer_.expires_after(grace);
+            graceTimer_.async_wait([this](const boost::system::error_code& ec)
+                {
+                    if (!ec)
+                    {
+                        spillAll();
+                    }
+                });
+            finish();
+        });
+    thread_.waitStop();
+
+    std::cerr << "forward: " << sentBatches_ << " batches, " << sentBytes_ << " bytes acknowledged, "
+              << reconnects_ << " reconnects, " << spilledBytes_ << " bytes spilled to " << settings_.spill_
+              << ", " << droppedBytes_ << " bytes dropped" << std::endl;
+}
+
+void ForwardSink::write(const MessageView& msg)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    current_.append(msg.text_).push_back('\n');
+    if (current_.size() >= settings_.batchBytes_)
+    {
+        // Пока поток пересылки не обработал переданные пакеты, память сверх лимита не занимается.
+        // Один пакет передается всегда, чтобы поток пересылки мог сбросить его в файл
+        released_.wait(lock, [this]
+            {
+                auto posted = postedBytes_.load();
+                return !posted || memoryBytes_.load() + posted + current_.size() <= settings_.bufferBytes_;
+            });
+        postedBytes_ += current_.size();
+        ba::post(io_, [this, batch = std::move(current_)]() mutable
+            {
+                postedBytes_ -= batch.size();
+                enqueue(std::move(batch));
+                released();
+            });
+        current_.clear();
+    }
+}
+
+void ForwardSink::released()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+    }
+    released_.notify_all();
+}
+
+void ForwardSink::flushCurrent()
+{
+    // Пакет забирается под блокировкой, а передается без нее: сброс в файл не должен задерживать запись блоков
+    std::string batch;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        batch.swap(current_);
+    }
+    if (!batch.empty())
+    {
+        enqueue(std::move(batch));
+    }
+}
+
+void ForwardSink::tick()
+{
+    flushCurrent();
+    timer_.expires_after(settings_.interval_);
+    timer_.async_wait([this](const boost::system::error_code& ec)
+        {
+            if (!ec && !closing_)
+            {
+                tick();
+            }
+        });
+}
+
+void ForwardSink::enqueue(std::string batch)
+{
+    // Пока в файле есть пакеты, новые пакеты дописываются за ними, чтобы сохранить порядок
+    if (spillRead_ < spillSize_ || memoryBytes_ + postedBytes_ + batch.size() > settings_.bufferBytes_)
+    {
+        spill(batch);
+    }
+    else
+    {
+        memoryBytes_ += batch.size();
+        pending_.push_back(std::move(batch));
+    }
+    pump();
+}
+
+void ForwardSink::connect()
+{
+    auto generation = ++generation_;
+    socket_.async_connect(endpoint_, [this, generation](const boost::system::error_code& ec)
+        {
+            if (generation != generation_)
+            {
+                return;
+            }
+            if (ec)
+            {
+                fail(ec);
+                return;
+            }
+            connected_ = true;
+            backoff_ = minBackoff;
+            ack_ = 0;
+            acked_ = 0;
+            readAcks(generation);
+            pump();
+        });
+}
+
+void ForwardSink::readAcks(std::size_t generation)
+{
+    ba::async_read(socket_, ba::buffer(&ack_, sizeof(ack_)),
+        [this, generation](const boost::system::error_code& ec, std::size_t)
+        {
+            if (generation != generation_)
+            {
+                return;
+            }
+            if (ec)
+            {
+                fail(ec);
+                return;
+            }
+            auto count = be64toh(ack_);
+            while (acked_ < count && !inflight_.empty())
+            {
+                sentBatches_++;
+                sentBytes_ += inflight_.front().size();
+                memoryBytes_ -= inflight_.front().size();
+                inflight_.pop_front();
+                acked_++;
+            }
+            released();
+            readAcks(generation);
+            pump();
+        });
+}
+
+void ForwardSink::pump()
+{
+    if (connected_ && !writing_)
+    {
+        if (pending_.empty())
+        {
+            unspill();
+        }
+
+        // Несколько пакетов отправляются одной записью
+        std::vector<ba::const_buffer> buffers;
+        headers_.clear();
+        auto first = inflight_.size();
+        while (!pending_.empty() && inflight_.size() < settings_.inFlight_)
+        {
+            inflight_.push_back(std::move(pending_.front()));
+            pending_.pop_front();
+        }
+        headers_.reserve(inflight_.size() - first);
+        for (auto i = first; i < inflight_.size(); ++i)
+        {
+            headers_.push_back(htonl(static_cast<std::uint32_t>(inflight_[i].size())));
+        }
+        for (auto i = first; i < inflight_.size(); ++i)
+        {
+            buffers.push_back(ba::buffer(&headers_[i - first], sizeof(std::uint32_t)));
+            buffers.push_back(ba::buffer(inflight_[i]));
+        }
+
+        if (!buffers.empty())
+        {
+            TRACE_SCOPE("ForwardSink::write");
+            writing_ = true;
+            auto generation = generation_;
+            ba::async_write(socket_, buffers, [this, generation](const boost::system::error_code& ec, std::size_t)
+                {
+                    if (generation != generation_)
+                    {
+                        return;
+                    }
+                    writing_ = false;
+                    if (ec)
+                    {
+                        fail(ec);
+                        return;
+                    }
+                    pump();
+                });
+            return;
+        }
+    }
+    finish();
+}
+
+void ForwardSink::fail(const boost::system::error_code& ec)
+{
+    if (connected_)
+    {
+        std::cerr << "forward: connection to " << settings_.address_ << " lost: " << ec.message() << std::endl;
+    }
+    generation_++;
+    connected_ = false;
+    writing_ = false;
+    boost::system::error_code ignored;
+    socket_.close(ignored);
+
+    // Неподтвержденные пакеты будут отправлены повторно
+    while (!inflight_.empty())
+    {
+        pending_.push_front(std::move(inflight_.back()));
+        inflight_.pop_back();
+    }
+
+    if (closing_)
+    {
+        spillAll();
+        return;
+    }
+
+    reconnectTimer_.expires_after(backoff_);
+    backoff_ = std::min(backoff_ * 2, maxBackoff);
+    reconnectTimer_.async_wait([this](const boost::system::error_code& ec)
+        {
+            if (!ec && !closing_)
+            {
+                reconnects_++;
+                connect();
+            }
+        });
+}
+
+void ForwardSink::spill(const std::string& batch)
+{
+    if (!spillOut_.is_open())
+    {
+        spillOut_.open(settings_.spill_, std::ios::binary | std::ios::app);
+        if (!spillOut_)
+        {
+            std::cerr << "forward: cannot open " << settings_.spill_ << ", batch dropped" << std::endl;
+            droppedBytes_ += batch.size();
+            return;
+        }
+    }
+    std::uint32_t size = htonl(static_cast<std::uint32_t>(batch.size()));
+    spillOut_.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    spillOut_.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+    spillOut_.flush();
+    if (!spillOut_)
+    {
+        // Частично записанный пакет отрезается, чтобы смещения файла остались согласованными
+        std::cerr << "forward: cannot write " << settings_.spill_ << ", batch dropped" << std::endl;
+        spillOut_.close();
+        std::error_code ec;
+        std::filesystem::resize_file(settings_.spill_, spillSize_, ec);
+        droppedBytes_ += batch.size();
+        return;
+    }
+    spillSize_ += sizeof(size) + batch.size();
+    spilledBytes_ += batch.size();
+}
+
+void ForwardSink::unspill()
+{
+    if (spillRead_ >= spillSize_)
+    {
+        return;
+    }
+    if (spillOut_.is_open())
+    {
+        spillOut_.flush();
+    }
+    if (!spillIn_.is_open())
+    {
+        spillIn_.open(settings_.spill_, std::ios::binary);
+        spillIn_.seekg(static_cast<std::streamoff>(spillRead_));
+    }
+
+    // Из файла читается не больше половины лимита памяти, чтобы новые пакеты не уходили в файл сразу
+    while (spillRead_ < spillSize_ && memoryBytes_ < settings_.bufferBytes_ / 2)
+    {
+        std::uint32_t size = 0;
+        std::string batch;
+        if (spillIn_.read(reinterpret_cast<char*>(&size), sizeof(size)))
+        {
+            batch.resize(ntohl(size));
+            spillIn_.read(&batch[0], static_cast<std::streamsize>(batch.size()));
+        }
+        if (!spillIn_)
+        {
+            std::cerr << "forward: " << settings_.spill_ << " is truncated, the rest of it is dropped" << std::endl;
+            spillRead_ = spillSize_;
+            break;
+        }
+        spillRead_ += sizeof(size) + batch.size();
+        memoryBytes_ += batch.size();
+        pending_.push_back(std::move(batch));
+    }
+
+    if (spillRead_ >= spillSize_)
+    {
+        spillIn_.close();
+        spillOut_.close();
+        std::remove(settings_.spill_.c_str());
+        spillRead_ = spillSize_ = 0;
+    }
+}
+
+void ForwardSink::finish()
+{
+    if (closing_ && pending_.empty() && inflight_.empty() && spillRead_ >= spillSize_)
+    {
+        graceTimer_.cancel();
+        reconnectTimer_.cancel();
+        boost::system::error_code ignored;
+        socket_.close(ignored);
+        work_.reset();
+        io_.stop();
+    }
+}
+
+void ForwardSink::spillAll()
+{
+    // Недоставленные пакеты старше непрочитанного остатка файла, поэтому файл переписывается:
+    // сначала пакеты из памяти, затем остаток, уже отправленная часть файла отбрасывается
+    auto tmp = settings_.spill_ + ".tmp";
+    bool written = false;
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        std::size_t bytes = 0;
+        for (auto* batches : {&inflight_, &pending_})
+        {
+            for (const auto& batch : *batches)
+            {
+                std::uint32_t size = htonl(static_cast<std::uint32_t>(batch.size()));
+                out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+                out.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+                bytes += batch.size();
+            }
+            batches->clear();
+        }
+        if (spillRead_ < spillSize_)
+        {
+            spillOut_.close();
+            std::ifstream in(settings_.spill_, std::ios::binary);
+            in.seekg(static_cast<std::streamoff>(spillRead_));
+            out << in.rdbuf();
+        }
+        out.flush();
+        written = static_cast<bool>(out);
+        if (written)
+        {
+            spilledBytes_ += bytes;
+        }
+        else
+        {
+            // Прежний файл сохраняется, его уже отправленная часть будет отправлена повторно
+            std::cerr << "forward: cannot write " << tmp << ", batches in memory are lost, "
+                      << settings_.spill_ << " is kept" << std::endl;
+            droppedBytes_ += bytes;
+        }
+    }
+    spillOut_.close();
+    spillIn_.close();
+    if (!written)
+    {
+        std::remove(tmp.c_str());
+    }
+    else if (std::ifstream(tmp, std::ios::binary | std::ios::ate).tellg() > 0)
+    {
+        std::rename(tmp.c_str(), settings_.spill_.c_str());
+    }
+    else
+    {
+        std::remove(tmp.c_str());
+        std::remove(settings_.spill_.c_str());
+    }
+    memoryBytes_ = 0;
+    spillRead_ = spillSize_ = 0;
+    released();
+
+    generation_++;
+    graceTimer_.cancel();
+    reconnectTimer_.cancel();
+    boost::system::error_code ignored;
+    socket_.close(ignored);
+    work_.reset();
+    io_.stop();
+}
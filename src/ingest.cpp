@@ -0,0 +1,175 @@
+/// @file
+/// @brief Файл с реализацией приложения пакетной обработки файлов без сети
+
+#include "async.h"
+#include "command_stream.h"
+#include "options.h"
+#include "thread.h"
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using namespace std::string_literals;
+
+namespace bip = boost::interprocess;
+
+namespace
+{
+
+constexpr std::size_t chunkSize = 64 * 1024; ///< размер порции данных, передаваемой за один раз
+
+/// @brief Обработать файл как одно соединение
+/// @param path путь к файлу
+/// @param n размер блока команд
+/// @param limits ограничения памяти разбора
+/// @return количество переданных на разбор байт
+std::size_t ingest(const std::string& path, std::size_t n, const BulkReader::Limits& limits)
+{
+    // Файл открывается до подключения, чтобы ошибка открытия не оставила незакрытое соединение
+    std::size_t size = std::filesystem::file_size(path);
+    bip::mapped_region region;
+    if (size)
+    {
+        bip::file_mapping mapping(path.c_str(), bip::read_only);
+        region = bip::mapped_region(mapping, bip::read_only);
+        region.advise(bip::mapped_region::advice_sequential);
+    }
+
+    CommandStream stream(n, limits);
+    std::size_t fed = 0;
+    if (size)
+    {
+        auto data = static_cast<const char*>(region.get_address());
+        while (fed < size)
+        {
+            auto chunk = std::min(chunkSize, size - fed);
+            bool ok = stream.feed(data + fed, chunk);
+            fed += chunk;
+            if (!ok)
+            {
+                std::cerr << path << ": parser limit exceeded before offset " << fed
+                          << ", rest of file skipped" << std::endl;
+                break;
+            }
+        }
+    }
+    stream.close();
+    return fed;
+}
+
+} //namespace
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        std::size_t n;
+        std::vector<std::string> files;
+        async::Options options;
+        BulkReader::Limits limits;
+
+        TraceOptions traceOpts;
+        po::options_description desc = asyncOptions(options);
+        desc.add(parserOptions(limits));
+        desc.add(traceOptions(traceOpts));
+        desc.add_options()
+            ("help,h", "print usage");
+        po::options_description hidden;
+        hidden.add_options()
+            ("bulk-size", po::value<int>())
+            ("file", po::value<std::vector<std::string>>(&files));
+        po::options_description all;
+        all.add(desc).add(hidden);
+        po::positional_options_description positional;
+        positional.add("bulk-size", 1).add("file", -1);
+
+        auto usage = "Usage: "s + argv[0] + " " + "<bulk size> <file> [<file> ...] [options]";
+        po::variables_map vm;
+        try
+        {
+            po::store(po::command_line_parser(argc, argv).options(all).positional(positional).run(), vm);
+            po::notify(vm);
+        }
+        catch (std::exception& e)
+        {
+            std::cerr << "Invalid argument: " << e.what() << '\n' << usage << '\n' << desc << std::endl;
+            return 1;
+        }
+
+        if (vm.count("help") || !vm.count("bulk-size") || files.empty())
+        {
+            std::cerr << usage << '\n' << desc << std::endl;
+            return vm.count("help") ? 0 : 1;
+        }
+        else try
+        {
+            auto size = vm["bulk-size"].as<int>();
+            if (size < 1)
+            {
+                throw std::invalid_argument("bulk size");
+            }
+            n = static_cast<std::size_t>(size);
+        }
+        catch (std::exception& e)
+        {
+            std::cerr << "Invalid argument: " << e.what() << '\n' << usage << std::endl;
+            return 1;
+        }
+
+        async::configure(options);
+        if (!traceOpts.file_.empty())
+        {
+            trace::enable(traceOpts.events_, traceOpts.sample_);
+        }
+
+        std::size_t threadCount = std::min<std::size_t>(files.size(), std::max(1u, std::thread::hardware_concurrency()));
+
+        std::atomic<std::size_t> next{0};
+        std::atomic<std::size_t> bytes{0};
+        std::atomic<std::size_t> ingested{0};
+        auto worker = [&]
+            {
+                for (std::size_t i = next++; i < files.size(); i = next++)
+                {
+                    try
+                    {
+                        bytes += ingest(files[i], n, limits);
+                        ingested++;
+                    }
+                    catch (const std::exception& ex)
+                    {
+                        std::cerr << files[i] << ": " << ex.what() << std::endl;
+                    }
+                }
+            };
+
+        auto start = std::chrono::steady_clock::now();
+        {
+            std::vector<std::unique_ptr<Thread>> threads;
+            for (std::size_t i = 0; i < threadCount; ++i)
+            {
+                threads.push_back(std::make_unique<Thread>("ingest" + std::to_string(i), worker));
+                threads.back()->start();
+            }
+        }
+        async::shutdown();
+        if (!traceOpts.file_.empty())
+        {
+            trace::dump(traceOpts.file_);
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cerr << "Ingested " << ingested << " of " << files.size() << " file(s), " << bytes << " bytes in "
+                  << elapsed.count() << " s (" << bytes / elapsed.count() / (1024 * 1024) << " MiB/s)" << std::endl;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "Exception: " << ex.what() << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,82 @@
+/// @file
+/// @brief Файл с реализацией таблицы интернирования команд
+
+#include "interner.h"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <new>
+
+Interner::Entry* Interner::Entry::create(std::string_view text, std::uint32_t id)
+{
+    void* block = ::operator new(sizeof(Entry) + text.size());
+    auto entry = new (block) Entry(text.size(), id);
+    std::memcpy(reinterpret_cast<char*>(entry + 1), text.data(), text.size());
+    return entry;
+}
+
+void Interner::Entry::release() const
+{
+    if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        this->~Entry();
+        ::operator delete(const_cast<Entry*>(this));
+    }
+}
+
+Interner::Interner(std::size_t capacity, std::size_t maxLength) :
+    shardCapacity_(std::max<std::size_t>(capacity / shardCount_, 1)),
+    maxLength_(maxLength)
+{
+}
+
+Command Interner::intern(std::string_view text)
+{
+    if (text.size() > maxLength_)
+    {
+        return Command(text);
+    }
+
+    auto hash = std::hash<std::string_view>()(text);
+    auto& shard = shards_[hash % shardCount_];
+    std::lock_guard<std::mutex> lock(shard.mutex_);
+
+    auto it = shard.map_.find(text);
+    if (it != shard.map_.end())
+    {
+        shard.lru_.splice(shard.lru_.begin(), shard.lru_, it->second);
+        shard.hits_++;
+        // Короткая строка хранится внутри объекта std::string и не экономит выделение памяти
+        if (text.size() > std::string().capacity())
+        {
+            shard.savedBytes_ += text.size();
+        }
+        return *it->second;
+    }
+
+    if (shard.lru_.size() >= shardCapacity_)
+    {
+        shard.map_.erase(std::string_view(shard.lru_.back()));
+        shard.lru_.pop_back();
+        shard.evictions_++;
+    }
+    shard.lru_.push_front(Command(Entry::create(text, nextId_++)));
+    shard.map_.emplace(std::string_view(shard.lru_.front()), shard.lru_.begin());
+    shard.misses_++;
+    return shard.lru_.front();
+}
+
+Interner::Stats Interner::stats() const
+{
+    Stats stats;
+    for (const auto& shard : shards_)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        stats.entries_ += shard.lru_.size();
+        stats.hits_ += shard.hits_;
+        stats.misses_ += shard.misses_;
+        stats.evictions_ += shard.evictions_;
+        stats.savedBytes_ += shard.savedBytes_;
+    }
+    return stats;
+}
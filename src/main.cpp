@@ -2,8 +2,15 @@
 /// @brief Файл с реализацией основного потока приложения
 
 #include "async_server.h"
+#include "async_session.h"
+#include "options.h"
+#include "thread.h"
 #include <boost/asio.hpp>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <unistd.h>
+#include <vector>
 
 using namespace std::string_literals;
 
@@ -14,29 +21,130 @@ int main(int argc, char* argv[])
     try
     {
         std::uint16_t port;
-        char* arg = argv[0];
+        async::Options options;
+        std::size_t ioThreads = 1;
+        CpuSet ioCpus;
+        async_server::Options serverOptions;
+        std::size_t unixWeight = 1;
+        std::size_t unixPriority = 0;
+        std::string unixPath;
+        std::string unixDgramPath;
+        int udpPort = 0;
+        int statsPort = 0;
 
-        auto usage = "Usage: "s + arg + " " + "<port> <bulk size>";
-        if (argc != 3)
+        TraceOptions traceOpts;
+        po::options_description desc = asyncOptions(options);
+        desc.add(parserOptions(serverOptions.limits_));
+        desc.add(traceOptions(traceOpts));
+        desc.add_options()
+            ("io-threads", po::value<std::size_t>(&ioThreads)->default_value(ioThreads),
+                "number of reactor threads running the io context")
+            ("io-cpus", po::value<std::string>()
+                ->notifier([&ioCpus](const std::string& list){ ioCpus = parseCpuList(list); }),
+                "CPUs of the reactor threads, one CPU per thread in turn")
+            ("slim", po::bool_switch(&serverOptions.slim_),
+                "low-footprint sessions for many idle connections (SIGUSR1 prints per-session memory)")
+            ("accepts", po::value<std::size_t>(&serverOptions.accepts_)->default_value(serverOptions.accepts_),
+                "concurrent pending accepts per listening socket")
+            ("backlog", po::value<int>(&serverOptions.backlog_)->default_value(serverOptions.backlog_),
+                "listen backlog (capped by net.core.somaxconn)")
+            ("session-pool", po::value<std::size_t>(&serverOptions.sessionPool_)->default_value(serverOptions.sessionPool_),
+                "sessions allocated in one slab and reused")
+            ("tcp-nodelay", po::bool_switch(&serverOptions.noDelay_),
+                "disable Nagle's algorithm on accepted TCP connections")
+            ("rcvbuf", po::value<int>(&serverOptions.receiveBuffer_)->default_value(serverOptions.receiveBuffer_),
+                "receive buffer of accepted connections, bytes (0 is the system default)")
+            ("defer-accept", po::value<int>(&serverOptions.deferAccept_)->default_value(serverOptions.deferAccept_),
+                "accept a TCP connection only when data arrives, waiting up to the seconds (0 is off)")
+            ("fair-weight", po::value<std::size_t>(&serverOptions.weight_)->default_value(serverOptions.weight_),
+                "--fair weight of TCP and UDP connections")
+            ("fair-priority", po::value<std::size_t>(&serverOptions.priority_)->default_value(serverOptions.priority_),
+                "--fair priority class (0 is served first, up to 3) of TCP and UDP connections")
+            ("unix-fair-weight", po::value<std::size_t>(&unixWeight)->default_value(unixWeight),
+                "--fair weight of Unix domain connections")
+            ("unix-fair-priority", po::value<std::size_t>(&unixPriority)->default_value(unixPriority),
+                "--fair priority class of Unix domain connections")
+            ("unix", po::value<std::string>(&unixPath),
+                "also listen on a Unix domain stream socket at the path")
+            ("udp", po::value<int>(&udpPort),
+                "also receive UDP datagrams on the port, each datagram is a batch of commands")
+            ("unix-dgram", po::value<std::string>(&unixDgramPath),
+                "also receive Unix domain datagrams at the path, each datagram is a batch of commands")
+            ("stats-port", po::value<int>(&statsPort),
+                "answer each TCP connection on the port with counters of processed commands and received datagrams")
+            ("help,h", "print usage");
+        po::options_description hidden;
+        hidden.add_options()
+            ("port", po::value<int>())
+            ("bulk-size", po::value<int>());
+        po::options_description all;
+        all.add(desc).add(hidden);
+        po::positional_options_description positional;
+        positional.add("port", 1).add("bulk-size", 1);
+
+        auto usage = "Usage: "s + argv[0] + " " + "<port> <bulk size> [options]";
+        po::variables_map vm;
+        try
+        {
+            po::store(po::command_line_parser(argc, argv).options(all).positional(positional).run(), vm);
+            po::notify(vm);
+        }
+        catch (std::exception& e)
         {
-            std::cerr << usage << std::endl;
+            std::cerr << "Invalid argument: " << e.what() << '\n' << usage << '\n' << desc << std::endl;
             return 1;
         }
+
+        if (vm.count("help") || !vm.count("port") || !vm.count("bulk-size"))
+        {
+            std::cerr << usage << '\n' << desc << std::endl;
+            return vm.count("help") ? 0 : 1;
+        }
         else try
         {
-            arg = argv[1];
-            port = std::stoi(arg);
-            if (port < 1)
+            auto p = vm["port"].as<int>();
+            if (p < 1 || p > 65535)
             {
                 throw std::invalid_argument("port");
             }
+            port = static_cast<std::uint16_t>(p);
 
-            arg = argv[2];
-            n = std::stoi(arg);
-            if (n < 1)
+            auto size = vm["bulk-size"].as<int>();
+            if (size < 1)
             {
                 throw std::invalid_argument("bulk size");
             }
+            n = static_cast<std::size_t>(size);
+
+            if (ioThreads < 1)
+            {
+                throw std::invalid_argument("io threads");
+            }
+
+            if (serverOptions.accepts_ < 1)
+            {
+                throw std::invalid_argument("accepts");
+            }
+
+            if (serverOptions.weight_ < 1 || unixWeight < 1)
+            {
+                throw std::invalid_argument("fair weight");
+            }
+
+            if (serverOptions.priority_ > 3 || unixPriority > 3)
+            {
+                throw std::invalid_argument("fair priority");
+            }
+
+            if (udpPort < 0 || udpPort > 65535)
+            {
+                throw std::invalid_argument("udp port");
+            }
+
+            if (statsPort < 0 || statsPort > 65535)
+            {
+                throw std::invalid_argument("stats port");
+            }
         }
         catch (std::exception& e)
         {
@@ -44,9 +152,85 @@ int main(int argc, char* argv[])
             return 1;
         }
 
+        async::configure(options);
+        if (!traceOpts.file_.empty())
+        {
+            trace::enable(traceOpts.events_, traceOpts.sample_);
+        }
+
+        async_server::Options localOptions = serverOptions;
+        localOptions.weight_ = unixWeight;
+        localOptions.priority_ = unixPriority;
+
         async_server::ba::io_context io_context;
-        async_server::Server server(io_context, port);
-        io_context.run();
+        async_server::Server server(io_context, {async_server::ba::ip::tcp::v4(), port}, serverOptions);
+
+        std::unique_ptr<async_server::LocalServer> localServer;
+        if (!unixPath.empty())
+        {
+            ::unlink(unixPath.c_str());
+            localServer = std::make_unique<async_server::LocalServer>(io_context, unixPath, localOptions);
+        }
+        std::unique_ptr<async_server::DatagramServer> datagramServer;
+        if (udpPort)
+        {
+            datagramServer = std::make_unique<async_server::DatagramServer>(io_context,
+                async_server::ba::ip::udp::endpoint(async_server::ba::ip::udp::v4(), static_cast<std::uint16_t>(udpPort)), serverOptions);
+        }
+        std::unique_ptr<async_server::LocalDatagramServer> localDatagramServer;
+        if (!unixDgramPath.empty())
+        {
+            ::unlink(unixDgramPath.c_str());
+            localDatagramServer = std::make_unique<async_server::LocalDatagramServer>(io_context, unixDgramPath, localOptions);
+        }
+
+        std::unique_ptr<async_server::StatsServer> statsServer;
+        if (statsPort)
+        {
+            statsServer = std::make_unique<async_server::StatsServer>(io_context,
+                async_server::ba::ip::tcp::endpoint(async_server::ba::ip::tcp::v4(), static_cast<std::uint16_t>(statsPort)));
+        }
+
+        // Корректное завершение по сигналу, чтобы исполнитель успел обработать и зафиксировать принятые данные
+        async_server::ba::signal_set signals(io_context, SIGINT, SIGTERM);
+        signals.async_wait([&io_context](boost::system::error_code, int){ io_context.stop(); });
+
+        async_server::ba::signal_set statsSignal(io_context, SIGUSR1);
+        std::function<void(boost::system::error_code, int)> printStats = [&](boost::system::error_code ec, int)
+            {
+                if (!ec)
+                {
+                    async_server::printSessionStats(std::cerr);
+                    statsSignal.async_wait(printStats);
+                }
+            };
+        statsSignal.async_wait(printStats);
+
+        {
+            std::vector<std::unique_ptr<Thread>> reactors;
+            for (std::size_t i = 0; i < ioThreads; ++i)
+            {
+                reactors.push_back(std::make_unique<Thread>("reactor" + std::to_string(i),
+                    [&io_context, &options]{ runWith(io_context, options.wait_); }));
+                if (!ioCpus.empty())
+                {
+                    reactors.back()->setAffinity({ioCpus[i % ioCpus.size()]});
+                }
+                reactors.back()->start();
+            }
+        }
+        async::shutdown();
+        for (const auto& path : {unixPath, unixDgramPath})
+        {
+            if (!path.empty())
+            {
+                ::unlink(path.c_str());
+            }
+        }
+        if (!traceOpts.file_.empty())
+        {
+            trace::dump(traceOpts.file_);
+        }
     }
     catch (const std::exception& ex)
     {
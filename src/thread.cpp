@@ -0,0 +1,72 @@
+/// @file
+/// @brief Файл с реализацией настройки потоков исполнения
+
+#include "thread.h"
+#include <pthread.h>
+#include <sched.h>
+#ifdef HAVE_LIBNUMA
+#include <numa.h>
+#endif
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+CpuSet parseCpuList(const std::string& list)
+{
+    CpuSet cpus;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ','))
+    {
+        if (range.empty())
+        {
+            continue;
+        }
+        auto dash = range.find('-');
+        int first = std::stoi(range.substr(0, dash));
+        int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        if (first < 0 || last < first || first >= CPU_SETSIZE || last >= CPU_SETSIZE)
+        {
+            throw std::invalid_argument("cpu list: " + list);
+        }
+        for (int cpu = first; cpu <= last; ++cpu)
+        {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+void Thread::setupCurrent(const std::string& name, const CpuSet& cpus)
+{
+    pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+
+    if (cpus.empty())
+    {
+        return;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (auto cpu : cpus)
+    {
+        CPU_SET(cpu, &set);
+    }
+    if (int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set))
+    {
+        std::cerr << name << ": cannot set affinity: " << std::strerror(err) << std::endl;
+        return;
+    }
+
+#ifdef HAVE_LIBNUMA
+    if (numa_available() >= 0)
+    {
+        int node = numa_node_of_cpu(cpus.front());
+        if (node >= 0)
+        {
+            numa_set_preferred(node);
+        }
+    }
+#endif
+}
@@ -0,0 +1,177 @@
+/// @file
+/// @brief Файл с реализацией записи событий трассировки конвейера обработки команд
+
+#include "trace.h"
+#include <iostream>
+
+#ifdef WITH_TRACE
+
+#include <cxxabi.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace trace
+{
+
+std::atomic_bool enabled{false};
+
+namespace
+{
+
+struct Event
+{
+    const char* name_ = nullptr;
+    const char* arg_ = nullptr;
+    std::uint64_t start_ = 0;
+    std::uint64_t end_ = 0;
+};
+
+/// @brief Кольцевой буфер событий одного потока
+/// @details Пишется только своим потоком, поэтому запись не требует блокировок
+struct Ring
+{
+    Ring(std::size_t size) : events_(size) { }
+
+    std::vector<Event> events_;
+    std::atomic<std::size_t> head_{0};
+    long tid_ = 0;
+    std::string name_;
+};
+
+std::mutex ringsMutex;
+std::vector<std::shared_ptr<Ring>> rings;
+std::size_t ringSize = 0;
+std::size_t sampleEvery = 1;
+
+Ring& ring()
+{
+    thread_local std::shared_ptr<Ring> local = []
+        {
+            auto r = std::make_shared<Ring>(ringSize);
+            r->tid_ = ::syscall(SYS_gettid);
+            char name[16] = {};
+            pthread_getname_np(pthread_self(), name, sizeof(name));
+            r->name_ = name;
+
+            std::lock_guard<std::mutex> lock(ringsMutex);
+            rings.push_back(r);
+            return r;
+        }();
+    return *local;
+}
+
+std::string demangle(const char* name)
+{
+    int status = 0;
+    std::unique_ptr<char, void(*)(void*)> demangled(abi::__cxa_demangle(name, nullptr, nullptr, &status), std::free);
+    return status == 0 ? demangled.get() : name;
+}
+
+} //namespace
+
+std::uint64_t now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool sample()
+{
+    if (sampleEvery == 1)
+    {
+        return true;
+    }
+    // Псевдослучайная выборка вместо счетчика, чтобы периодичность событий не совпадала с периодом выборки
+    thread_local std::uint64_t state = 0x9e3779b97f4a7c15ull ^ reinterpret_cast<std::uintptr_t>(&state);
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state % sampleEvery == 0;
+}
+
+void record(const char* name, std::uint64_t start, const char* arg)
+{
+    auto& r = ring();
+    auto head = r.head_.load(std::memory_order_relaxed);
+    r.events_[head % r.events_.size()] = {name, arg, start, now()};
+    r.head_.store(head + 1, std::memory_order_release);
+}
+
+void enable(std::size_t events, std::size_t every)
+{
+    ringSize = events ? events : 1;
+    sampleEvery = every ? every : 1;
+    enabled.store(true);
+}
+
+bool dump(const std::string& path)
+{
+    if (!enabled.load())
+    {
+        return false;
+    }
+
+    std::ofstream ofs(path);
+    if (!ofs)
+    {
+        std::cerr << "trace: cannot open " << path << std::endl;
+        return false;
+    }
+
+    auto pid = ::getpid();
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    ofs << std::fixed << std::setprecision(3) << "{\"traceEvents\":[\n";
+    bool first = true;
+    for (const auto& r : rings)
+    {
+        ofs << (first ? "" : ",\n")
+            << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << r->tid_
+            << ",\"args\":{\"name\":\"" << r->name_ << "\"}}";
+        first = false;
+
+        auto head = r->head_.load(std::memory_order_acquire);
+        auto size = r->events_.size();
+        for (auto i = head > size ? head - size : 0; i < head; ++i)
+        {
+            const auto& e = r->events_[i % size];
+            ofs << ",\n{\"name\":\"" << e.name_ << "\",\"cat\":\"bulk\",\"ph\":\"X\",\"pid\":" << pid
+                << ",\"tid\":" << r->tid_ << ",\"ts\":" << e.start_ / 1000.0 << ",\"dur\":" << (e.end_ - e.start_) / 1000.0;
+            if (e.arg_)
+            {
+                ofs << ",\"args\":{\"type\":\"" << demangle(e.arg_) << "\"}";
+            }
+            ofs << "}";
+        }
+    }
+    ofs << "\n]}\n";
+    return true;
+}
+
+} //namespace trace
+
+#else
+
+namespace trace
+{
+
+void enable(std::size_t, std::size_t)
+{
+    std::cerr << "trace: recording is disabled at compile time (WITH_TRACE)" << std::endl;
+}
+
+bool dump(const std::string&)
+{
+    return false;
+}
+
+} //namespace trace
+
+#endif